@@ -0,0 +1,78 @@
+#include "contadores_perf.hpp"
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+
+namespace {
+    const uint64_t EVENTOS[4] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    int abrir_evento(uint64_t evento) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = evento;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // Permitido com perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+}
+
+ContadoresPerf::ContadoresPerf(int num_threads) : descritores(num_threads * NUM_EVENTOS, -1), ativo(false) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int t = omp_get_thread_num();
+        for (int e = 0; e < NUM_EVENTOS; ++e) descritores[t * NUM_EVENTOS + e] = abrir_evento(EVENTOS[e]);
+    }
+    // Basta o contador de ciclos de todas as threads para os resultados fazerem sentido
+    ativo = true;
+    for (int t = 0; t < num_threads; ++t) ativo = ativo && descritores[t * NUM_EVENTOS] >= 0;
+}
+
+ContadoresPerf::~ContadoresPerf() {
+    for (int fd : descritores) if (fd >= 0) close(fd);
+}
+
+void ContadoresPerf::iniciar() {
+    if (!ativo) return;
+    for (int fd : descritores) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+LeituraPerf ContadoresPerf::parar() {
+    LeituraPerf soma;
+    if (!ativo) return soma;
+    for (int fd : descritores) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+
+    uint64_t* campos[NUM_EVENTOS] = {&soma.ciclos, &soma.instrucoes, &soma.falhas_cache, &soma.falhas_desvio};
+    for (size_t i = 0; i < descritores.size(); ++i) {
+        uint64_t valor = 0;
+        if (descritores[i] >= 0 && read(descritores[i], &valor, sizeof(valor)) == (ssize_t)sizeof(valor)) {
+            *campos[i % NUM_EVENTOS] += valor;
+        }
+    }
+    return soma;
+}
+
+#else
+
+ContadoresPerf::ContadoresPerf(int) : ativo(false) {}
+ContadoresPerf::~ContadoresPerf() {}
+void ContadoresPerf::iniciar() {}
+LeituraPerf ContadoresPerf::parar() { return LeituraPerf(); }
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CONTADORES_PERF_HPP
+#define CONTADORES_PERF_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Contadores de hardware opcionais via perf_event_open (Linux).
+//
+// Cada thread OpenMP abre os seus contadores (pid = 0: só a própria thread) numa região paralela
+// com `num_threads` threads; como o runtime reaproveita as mesmas threads nas regiões seguintes,
+// a soma dos contadores de todas elas cobre o trabalho de qualquer equipe de até `num_threads`.
+// Sem permissão (perf_event_paranoid alto, contêiner) ou fora do Linux, disponivel() é false
+// e o microbenchmark segue só com o tempo.
+struct LeituraPerf {
+    uint64_t ciclos = 0;
+    uint64_t instrucoes = 0;
+    uint64_t falhas_cache = 0;   // Falhas no último nível de cache
+    uint64_t falhas_desvio = 0;  // Desvios mal previstos
+};
+
+class ContadoresPerf {
+private:
+    static constexpr int NUM_EVENTOS = 4;
+    std::vector<int> descritores; // NUM_EVENTOS por thread (-1 se o evento não abriu)
+    bool ativo;
+
+public:
+    explicit ContadoresPerf(int num_threads);
+    ~ContadoresPerf();
+
+    ContadoresPerf(const ContadoresPerf&) = delete;
+    ContadoresPerf& operator=(const ContadoresPerf&) = delete;
+
+    bool disponivel() const { return ativo; }
+
+    // Zera e liga todos os contadores
+    void iniciar();
+
+    // Desliga e devolve a soma de todas as threads
+    LeituraPerf parar();
+};
+
+#endif // CONTADORES_PERF_HPP
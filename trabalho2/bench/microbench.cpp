@@ -0,0 +1,350 @@
+// Microbenchmarks dos kernels do trabalho2, no estilo do Google Benchmark: cada caso é
+// registrado com seus argumentos (tamanho do grid, densidade de agentes, contenção) e número de
+// threads, e roda em lotes de iterações que dobram até passar de --min-tempo segundos.
+// O relatório traz tempo por iteração, vazão (itens/s) e ciclos por item; com contadores de
+// hardware disponíveis (perf_event), os ciclos são medidos e aparecem também IPC e falhas de
+// cache por item. Sem eles, os ciclos são estimados pelo TSC (marcados com ~).
+//
+// Serve para avaliar uma otimização de um kernel isolado sem rodar a simulação MPI inteira.
+// Os kernels completos de agente (kernel_escalar/kernel_lote) incluem a carga sintética quando
+// CARGA_SINTETICA está ligada; decidir mede só o estêncil de decisão.
+//
+//     microbench [--filtro TEXTO] [--min-tempo S] [--max-threads T] [--csv]
+
+#include <mpi.h>
+#include <omp.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "territorio.hpp"
+#include "agente.hpp"
+#include "comunicacao.hpp"
+#include "kernel_agentes.hpp"
+#include "tabela_somas.hpp"
+#include "piramide.hpp"
+#include "contadores_perf.hpp"
+
+namespace {
+    // Um caso já preparado: a iteração processa `itens_por_iteracao` itens
+    struct Caso {
+        double itens_por_iteracao;
+        std::function<void()> iteracao;
+    };
+
+    // Caso registrado; o estado (grid, agentes) só é montado se o filtro o selecionar
+    struct Registro {
+        std::string nome;
+        int threads;
+        std::function<Caso()> preparar;
+    };
+
+    std::vector<Registro> registros;
+
+    void registrar(const std::string& nome, int threads, std::function<Caso()> preparar) {
+        registros.push_back(Registro{nome + "/t:" + std::to_string(threads), threads, std::move(preparar)});
+    }
+
+    uint64_t ler_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // Território com os recursos iniciais (first-touch pelas threads do caso)
+    std::shared_ptr<Territorio> novo_territorio(int largura, int altura) {
+        auto t = std::make_shared<Territorio>(largura, altura, Posicao(0, 0));
+        t->inicializar(Estacao::SECA);
+        return t;
+    }
+
+    // `densidade` agentes por célula em posições pseudoaleatórias fixas
+    std::shared_ptr<std::vector<Agente>> novos_agentes(int largura, int altura, double densidade) {
+        auto agentes = std::make_shared<std::vector<Agente>>();
+        int n = (int)(densidade * largura * altura);
+        uint32_t estado = 12345u;
+        agentes->reserve(n);
+        for (int i = 0; i < n; ++i) {
+            estado = estado * 1664525u + 1013904223u;
+            int x = (estado >> 8) % largura;
+            estado = estado * 1664525u + 1013904223u;
+            int y = (estado >> 8) % altura;
+            agentes->push_back(Agente(Posicao(x, y), 20.0f));
+        }
+        return agentes;
+    }
+
+    // Saída do kernel de agentes que só acumula (como as listas por thread da simulação)
+    struct SaidaContagem {
+        std::vector<Agente>& lista;
+        void morte() {}
+        void migrante(Direcao, const Agente& a) { lista.push_back(a); }
+        void local(const Agente& a) { lista.push_back(a); }
+        void nascimento(const Agente& filho) { lista.push_back(filho); }
+    };
+
+    volatile long long sumidouro; // Impede que o compilador descarte resultados não usados
+
+    void registrar_casos(int max_threads) {
+        std::vector<int> lista_threads;
+        for (int t = 1; t < max_threads; t *= 2) lista_threads.push_back(t);
+        lista_threads.push_back(max_threads);
+
+        const int grids[3][2] = {{1000, 250}, {1000, 1000}, {4000, 1000}};
+        const double densidades[2] = {0.02, 0.2};
+        auto nome_densidade = [](double d) {
+            char txt[32];
+            std::snprintf(txt, sizeof(txt), "densidade:%g", d);
+            return std::string(txt);
+        };
+
+        // Atualização das células (regeneração, consumo, clamp): itens = células
+        for (const auto& g : grids) {
+            for (int t : lista_threads) {
+                int largura = g[0], altura = g[1];
+                registrar("atualizar_recursos/" + std::to_string(largura) + "x" + std::to_string(altura), t, [=] {
+                    auto grid = novo_territorio(largura, altura);
+                    return Caso{(double)largura * altura, [grid] { grid->atualizar_recursos(Estacao::CHEIA); }};
+                });
+            }
+        }
+
+        // Construção da tabela de somas (recurso e densidade de agentes, 0.1 por célula): itens = células
+        for (const auto& g : grids) {
+            for (int t : lista_threads) {
+                int largura = g[0], altura = g[1];
+                registrar("tabela_somas/" + std::to_string(largura) + "x" + std::to_string(altura), t, [=] {
+                    auto grid = novo_territorio(largura, altura);
+                    auto agentes = novos_agentes(largura, altura, 0.1);
+                    auto tabela = std::make_shared<TabelaSomas>();
+                    return Caso{(double)largura * altura, [grid, agentes, tabela] {
+                        tabela->construir(*grid, agentes->data(), (int)agentes->size());
+                    }};
+                });
+            }
+        }
+
+        // Reconstrução da pirâmide de recursos num processo (sem troca de bordas): itens = células
+        for (const auto& g : grids) {
+            for (int t : lista_threads) {
+                int largura = g[0], altura = g[1];
+                registrar("piramide/" + std::to_string(largura) + "x" + std::to_string(altura), t, [=] {
+                    auto grid = novo_territorio(largura, altura);
+                    auto piramide = std::make_shared<PiramideRecursos>(largura, altura, 0, altura);
+                    return Caso{(double)largura * altura, [grid, piramide] {
+                        piramide->atualizar(*grid, MPI_COMM_SELF, 0, 1);
+                    }};
+                });
+            }
+        }
+
+        // Só o estêncil de decisão (8 vizinhos): itens = agentes
+        for (double d : densidades) {
+            for (int t : lista_threads) {
+                registrar("decidir/" + nome_densidade(d), t, [=] {
+                    auto grid = novo_territorio(1000, 250);
+                    auto agentes = novos_agentes(1000, 250, d);
+                    return Caso{(double)agentes->size(), [grid, agentes] {
+                        long long soma = 0;
+                        int n = (int)agentes->size();
+                        #pragma omp parallel for schedule(static) reduction(+:soma)
+                        for (int i = 0; i < n; ++i) {
+                            Posicao destino;
+                            (*agentes)[i].decidir(*grid, destino);
+                            soma += destino.x + destino.y;
+                        }
+                        sumidouro = soma;
+                    }};
+                });
+            }
+        }
+
+        // Ciclo completo do agente, escalar e em lote: itens = agentes
+        for (int lote = 0; lote < 2; ++lote) {
+            for (double d : densidades) {
+                for (int t : lista_threads) {
+                    registrar(std::string(lote ? "kernel_lote/" : "kernel_escalar/") + nome_densidade(d), t, [=] {
+                        auto grid = novo_territorio(1000, 250);
+                        auto agentes = novos_agentes(1000, 250, d);
+                        auto listas = std::make_shared<std::vector<std::vector<Agente>>>(t);
+                        return Caso{(double)agentes->size(), [grid, agentes, listas, lote] {
+                            int n = (int)agentes->size();
+                            #pragma omp parallel
+                            {
+                                int nt = omp_get_num_threads();
+                                int id = omp_get_thread_num();
+                                int ini = (int)((long long)n * id / nt);
+                                int fim = (int)((long long)n * (id + 1) / nt);
+                                std::vector<Agente>& lista = (*listas)[id];
+                                lista.clear();
+                                SaidaContagem saida{lista};
+                                if (lote) {
+                                    processar_lote_agentes(agentes->data() + ini, fim - ini, *grid, saida);
+                                } else {
+                                    for (int i = ini; i < fim; ++i) processar_agente_escalar((*agentes)[i], *grid, saida);
+                                }
+                            }
+                        }};
+                    });
+                }
+            }
+        }
+
+        // Consumo atômico sob contenção: 1M atualizações espalhadas em C células; itens = atualizações
+        for (int celulas : {1, 64, 4096, 250000}) {
+            for (int t : lista_threads) {
+                registrar("registrar_consumo/celulas:" + std::to_string(celulas), t, [=] {
+                    auto grid = novo_territorio(1000, 250);
+                    auto posicoes = std::make_shared<std::vector<Posicao>>();
+                    for (int c = 0; c < celulas; ++c) {
+                        long long indice = (long long)c * 250000 / celulas;
+                        posicoes->push_back(Posicao((int)(indice % 1000), (int)(indice / 1000)));
+                    }
+                    const int atualizacoes = 1 << 20;
+                    return Caso{(double)atualizacoes, [grid, posicoes, celulas] {
+                        #pragma omp parallel for schedule(static)
+                        for (int i = 0; i < atualizacoes; ++i) {
+                            grid->registrar_consumo((*posicoes)[i % celulas], 0.5f);
+                        }
+                    }};
+                });
+            }
+        }
+
+        // Empacotamento dos halos (H linhas com passo da grade com borda, como no bloco temporal)
+        // e dos migrantes no formato compacto: sequenciais, itens = células / agentes
+        for (int linhas : {1, 3, 9}) {
+            registrar("empacotar_halo/linhas:" + std::to_string(linhas), 1, [=] {
+                auto grid = novo_territorio(1000, 250);
+                auto tipo = std::make_shared<MPI_Datatype>();
+                MPI_Type_vector(linhas, grid->get_largura(), grid->get_passo(), MPI_FLOAT, tipo.get());
+                MPI_Type_commit(tipo.get());
+                int bytes = 0;
+                MPI_Pack_size(1, *tipo, MPI_COMM_SELF, &bytes);
+                auto buffer = std::make_shared<std::vector<char>>(bytes);
+                return Caso{(double)linhas * grid->get_largura(), [grid, tipo, buffer] {
+                    int posicao = 0;
+                    MPI_Pack(grid->ptr_recurso(Posicao(0, 0)), 1, *tipo, buffer->data(), (int)buffer->size(),
+                             &posicao, MPI_COMM_SELF);
+                }};
+            });
+        }
+        registrar("empacotar_migrantes/lote:" + std::to_string(Config::TAMANHO_LOTE_MIGRACAO), 1, [] {
+            auto agentes = novos_agentes(1000, 250, (double)Config::TAMANHO_LOTE_MIGRACAO / 250000);
+            auto pacote = std::make_shared<std::vector<unsigned char>>(FormatoMigracao::tamanho_pacote((int)agentes->size()));
+            return Caso{(double)agentes->size(), [agentes, pacote] {
+                FormatoMigracao::empacotar(agentes->data(), (int)agentes->size(), pacote->data());
+            }};
+        });
+    }
+
+    struct Resultado {
+        long long iteracoes;
+        double segundos;
+        uint64_t tsc;
+        LeituraPerf perf;
+    };
+
+    // Lotes de iterações crescentes até o lote durar pelo menos `min_tempo`
+    Resultado medir(const Caso& caso, double min_tempo, ContadoresPerf& contadores) {
+        caso.iteracao(); // Aquecimento (caches, páginas, pool de threads)
+
+        long long n = 1;
+        for (;;) {
+            contadores.iniciar();
+            uint64_t tsc_inicio = ler_tsc();
+            double inicio = omp_get_wtime();
+            for (long long i = 0; i < n; ++i) caso.iteracao();
+            double segundos = omp_get_wtime() - inicio;
+            uint64_t tsc = ler_tsc() - tsc_inicio;
+            LeituraPerf perf = contadores.parar();
+
+            if (segundos >= min_tempo || n >= (1LL << 30)) return Resultado{n, segundos, tsc, perf};
+            double fator = segundos > 0.0 ? 1.4 * min_tempo / segundos : 10.0;
+            if (fator < 2.0) fator = 2.0;
+            if (fator > 10.0) fator = 10.0;
+            n = (long long)(n * fator);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv); // Só para MPI_Pack e os datatypes (um processo, sem comunicação)
+
+    std::string filtro;
+    double min_tempo = 0.2;
+    int max_threads = omp_get_max_threads();
+    bool csv = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filtro") == 0 && i + 1 < argc) filtro = argv[++i];
+        else if (std::strcmp(argv[i], "--min-tempo") == 0 && i + 1 < argc) min_tempo = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-threads") == 0 && i + 1 < argc) max_threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--csv") == 0) csv = true;
+        else {
+            std::fprintf(stderr, "Uso: %s [--filtro TEXTO] [--min-tempo S] [--max-threads T] [--csv]\n", argv[0]);
+            MPI_Finalize();
+            return 1;
+        }
+    }
+    if (max_threads < 1) max_threads = 1;
+
+    registrar_casos(max_threads);
+    ContadoresPerf contadores(max_threads);
+
+    if (csv) {
+        std::printf("nome,threads,iteracoes,ns_por_iteracao,itens_por_s,ciclos_por_item,ciclos_medidos,ipc,falhas_cache_por_item\n");
+    } else {
+        std::printf("Contadores de hardware: %s\n", contadores.disponivel() ? "perf_event" : "indisponíveis (ciclos estimados pelo TSC)");
+        std::printf("%-44s %14s %10s %14s %12s %6s %12s\n", "Caso", "Tempo/iter", "Iterações", "Itens/s", "Ciclos/item", "IPC", "Falhas/item");
+        std::printf("%s\n", std::string(118, '-').c_str());
+    }
+
+    for (const Registro& r : registros) {
+        if (!filtro.empty() && r.nome.find(filtro) == std::string::npos) continue;
+
+        omp_set_num_threads(r.threads);
+        Caso caso = r.preparar();
+        Resultado res = medir(caso, min_tempo, contadores);
+
+        double itens = caso.itens_por_iteracao * res.iteracoes;
+        double ns_por_iteracao = res.segundos * 1e9 / res.iteracoes;
+        double itens_por_s = itens / res.segundos;
+
+        // Ciclos de CPU consumidos por item, somando as threads. Sem perf_event, estimativa pelo
+        // TSC (ciclos de parede x threads, supondo todas ocupadas)
+        bool medidos = contadores.disponivel();
+        double ciclos = medidos ? (double)res.perf.ciclos : (double)res.tsc * r.threads;
+        double ciclos_por_item = ciclos / itens;
+        double ipc = (medidos && res.perf.ciclos > 0) ? (double)res.perf.instrucoes / res.perf.ciclos : 0.0;
+        double falhas_por_item = medidos ? res.perf.falhas_cache / itens : 0.0;
+
+        if (csv) {
+            std::printf("%s,%d,%lld,%.3f,%.6g,%.3f,%d,%.3f,%.6f\n", r.nome.c_str(), r.threads, res.iteracoes,
+                        ns_por_iteracao, itens_por_s, ciclos_por_item, medidos ? 1 : 0, ipc, falhas_por_item);
+        } else {
+            char tempo[32], ciclos_txt[32], ipc_txt[16], falhas_txt[32];
+            if (ns_por_iteracao >= 1e6) std::snprintf(tempo, sizeof(tempo), "%.3f ms", ns_por_iteracao / 1e6);
+            else if (ns_por_iteracao >= 1e3) std::snprintf(tempo, sizeof(tempo), "%.3f us", ns_por_iteracao / 1e3);
+            else std::snprintf(tempo, sizeof(tempo), "%.1f ns", ns_por_iteracao);
+            std::snprintf(ciclos_txt, sizeof(ciclos_txt), "%s%.2f", medidos ? "" : "~", ciclos_por_item);
+            std::snprintf(ipc_txt, sizeof(ipc_txt), medidos ? "%.2f" : "-", ipc);
+            std::snprintf(falhas_txt, sizeof(falhas_txt), medidos ? "%.4f" : "-", falhas_por_item);
+            std::printf("%-44s %14s %10lld %14.4g %12s %6s %12s\n", r.nome.c_str(), tempo, res.iteracoes,
+                        itens_por_s, ciclos_txt, ipc_txt, falhas_txt);
+        }
+        std::fflush(stdout);
+    }
+
+    MPI_Finalize();
+    return 0;
+}
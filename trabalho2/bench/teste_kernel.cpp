@@ -0,0 +1,17 @@
+// Teste de equivalência do kernel de agentes: o caminho em lote (processar_lote_agentes) precisa
+// reproduzir o escalar bit a bit, nas duas estações e com as flags de compilação do build.
+// Roda sem argumentos e sai com código diferente de zero se os dois caminhos divergirem
+// (make teste compila e executa com as flags de cada variante).
+
+#include <mpi.h>
+#include <cstdio>
+#include "kernel_agentes.hpp"
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv); // Um processo, sem comunicação (a pirâmide recebe MPI_COMM_SELF)
+    bool ok = verificar_kernel_lote();
+    std::printf("Verificação do kernel em lote (lote x escalar, LARGURA_LOTE_AGENTES=%d): %s\n",
+                Config::LARGURA_LOTE_AGENTES, ok ? "OK" : "FALHOU");
+    MPI_Finalize();
+    return ok ? 0 : 1;
+}
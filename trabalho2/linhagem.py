@@ -0,0 +1,114 @@
+import glob
+import sys
+from collections import Counter
+
+# Decodifica os arquivos do log de linhagem (--linhagem <prefixo>, formato em src/linhagem.hpp)
+# e imprime um resumo, ou a história e a ascendência de um agente:
+#
+#     python3 linhagem.py <prefixo>            resumo por tipo de evento
+#     python3 linhagem.py <prefixo> <id>       eventos do agente e cadeia de ancestrais
+
+TIPOS = ["nascimento", "morte", "migracao_cima", "migracao_baixo"]
+
+
+def ler_varint(dados: bytes, pos: int):
+	"""Lê um inteiro LEB128 a partir de `pos`; devolve (valor, nova posição)."""
+	valor = 0
+	deslocamento = 0
+	while True:
+		byte = dados[pos]
+		pos += 1
+		valor |= (byte & 0x7F) << deslocamento
+		if byte < 0x80:
+			return valor, pos
+		deslocamento += 7
+
+
+def desfazer_zigue_zague(valor: int):
+	return (valor >> 1) ^ -(valor & 1)
+
+
+def ler_arquivo(caminho: str):
+	"""Devolve (cabeçalho, lista de eventos (ciclo, tipo, id, pai)) de um arquivo de rank."""
+	with open(caminho, "rb") as f:
+		dados = f.read()
+	fim_cabecalho = dados.index(b"\n")
+	campos = dict(c.split("=") for c in dados[:fim_cabecalho].decode().split()[1:])
+	eventos = []
+	pos = fim_cabecalho + 1
+	while pos < len(dados):
+		ciclo, pos = ler_varint(dados, pos)
+		tamanho, pos = ler_varint(dados, pos)
+		fim_bloco = pos + tamanho
+		contagens = []
+		for _ in TIPOS:
+			c, pos = ler_varint(dados, pos)
+			contagens.append(c)
+		pai = 0
+		for tipo, contagem in enumerate(contagens):
+			id_agente = 0
+			for _ in range(contagem):
+				delta, pos = ler_varint(dados, pos)
+				id_agente += delta
+				pai_evento = None
+				if tipo == 0:
+					delta_pai, pos = ler_varint(dados, pos)
+					pai += desfazer_zigue_zague(delta_pai)
+					pai_evento = pai
+				eventos.append((ciclo, TIPOS[tipo], id_agente, pai_evento))
+		if pos != fim_bloco:
+			raise ValueError(f"{caminho}: bloco do ciclo {ciclo} com tamanho inconsistente")
+	return campos, eventos
+
+
+def descrever(id_agente: int, bits: int):
+	origem = (id_agente >> bits) - 1
+	sequencia = id_agente & ((1 << bits) - 1)
+	if origem < 0:
+		return f"{id_agente} (população inicial, índice {sequencia})"
+	return f"{id_agente} (nascido no rank {origem}, nº {sequencia})"
+
+
+def main():
+	if len(sys.argv) not in (2, 3):
+		print(f"Uso: {sys.argv[0]} <prefixo> [id]")
+		return
+
+	arquivos = sorted(glob.glob(glob.escape(sys.argv[1]) + ".*"))
+	if not arquivos:
+		print(f"[ERRO] Nenhum arquivo {sys.argv[1]}.<rank> encontrado.")
+		return
+
+	eventos = []
+	bits = 40
+	for caminho in arquivos:
+		campos, eventos_rank = ler_arquivo(caminho)
+		bits = int(campos["bits_sequencia"])
+		rank = int(campos["rank"])
+		eventos.extend((ciclo, rank, tipo, id_agente, pai) for ciclo, tipo, id_agente, pai in eventos_rank)
+	eventos.sort()
+
+	if len(sys.argv) == 2:
+		contagem = Counter(e[2] for e in eventos)
+		ciclos = {e[0] for e in eventos}
+		print(f"{len(arquivos)} arquivos, {len(eventos)} eventos em {len(ciclos)} ciclos")
+		for tipo in TIPOS:
+			print(f"  {tipo}: {contagem[tipo]}")
+		return
+
+	alvo = int(sys.argv[2])
+	pais = {e[3]: e[4] for e in eventos if e[2] == "nascimento"}
+	print(f"Agente {descrever(alvo, bits)}")
+	for ciclo, rank, tipo, id_agente, pai in eventos:
+		if id_agente == alvo:
+			extra = f" (pai {pai})" if pai is not None else ""
+			print(f"  ciclo {ciclo:5d} rank {rank:3d}: {tipo}{extra}")
+	print("Ascendência:")
+	atual = alvo
+	while atual in pais:
+		atual = pais[atual]
+		print(f"  {descrever(atual, bits)}")
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,172 @@
+import csv
+import os
+from collections import defaultdict
+
+try:
+	import matplotlib.pyplot as plt
+except ImportError:  # pragma: no cover - mensagem amigável em ambiente sem matplotlib
+	print("[ERRO] matplotlib não está instalado. Instale com 'pip install matplotlib' e rode novamente.")
+	raise
+
+
+RESULTS_CSV = os.path.join("results", "results.csv")
+PLOTS_DIR = "plots"
+FASES = ["halo", "agentes", "migracao", "recursos", "metricas"]
+
+
+def load_results(path: str):
+	"""Lê o CSV gerado pelo run.sh e devolve uma lista de dicionários."""
+	rows = []
+	with open(path, newline="") as f:
+		reader = csv.DictReader(f)
+		for row in reader:
+			# Conversão de tipos numéricos para facilitar o plot
+			for key in ("ranks", "threads", "largura", "altura", "agentes", "ciclos"):
+				row[key] = int(row[key])
+			for key in ["mean_total_s", "std_total_s"] + [f"mean_{fase}_s" for fase in FASES]:
+				row[key] = float(row[key])
+			row["pes"] = row["ranks"] * row["threads"]  # Elementos de processamento (ranks x threads)
+			rows.append(row)
+	return rows
+
+
+def ensure_outdir():
+	os.makedirs(PLOTS_DIR, exist_ok=True)
+
+
+def karp_flatt(speedup: float, p: int):
+	"""Fração serial experimental e = (1/S - 1/p) / (1 - 1/p); indefinida para p = 1."""
+	if p <= 1 or speedup <= 0:
+		return None
+	return (1.0 / speedup - 1.0 / p) / (1.0 - 1.0 / p)
+
+
+def plot_scaling(rows, base_time, title, fname_prefix, scaled):
+	"""Speedup, eficiência e Karp-Flatt contra ranks x threads, uma curva por número de threads.
+
+	Na escalabilidade forte, S = T(1x1) / T(p). Na fraca o problema cresce com os ranks e o
+	speedup é o escalonado (Gustafson): S = ranks x T(1 rank) / T(p), com o mesmo nº de threads
+	na base (eficiência fraca = T(1 rank) / T(p)).
+	"""
+	by_threads = defaultdict(list)
+	for r in rows:
+		by_threads[r["threads"]].append(r)
+
+	fig_s, ax_s = plt.subplots(figsize=(8, 5))
+	fig_e, ax_e = plt.subplots(figsize=(8, 5))
+	fig_k, ax_k = plt.subplots(figsize=(8, 5))
+	max_pes = max(r["pes"] for r in rows)
+
+	for threads, subset in sorted(by_threads.items()):
+		subset = sorted(subset, key=lambda r: r["pes"])
+		if scaled:
+			base_rows = [r for r in subset if r["ranks"] == 1]
+			if not base_rows:
+				continue
+			base = base_rows[0]["mean_total_s"]
+			speedups = [r["ranks"] * base / r["mean_total_s"] for r in subset]
+			procs = [r["ranks"] for r in subset]
+			pes = procs
+		else:
+			speedups = [base_time / r["mean_total_s"] for r in subset]
+			pes = [r["pes"] for r in subset]
+			procs = pes
+		efficiencies = [s / p for s, p in zip(speedups, procs)]
+		kf = [(p, karp_flatt(s, p)) for s, p in zip(speedups, procs)]
+		kf = [(p, e) for p, e in kf if e is not None]
+
+		label = f"{threads} thread(s)/rank"
+		ax_s.plot(pes, speedups, marker="o", label=label)
+		ax_e.plot(pes, efficiencies, marker="o", label=label)
+		if kf:
+			ax_k.plot([p for p, _ in kf], [e for _, e in kf], marker="o", label=label)
+
+	x_label = "Ranks MPI" if scaled else "Ranks x threads"
+	ideal_max = max(r["ranks"] for r in rows) if scaled else max_pes
+	ax_s.plot([1, ideal_max], [1, ideal_max], linestyle="--", color="gray", label="ideal")
+	ax_e.axhline(1.0, linestyle="--", color="gray", label="ideal")
+
+	for ax, fig, ylabel, suffix in (
+		(ax_s, fig_s, "Speedup escalonado" if scaled else "Speedup (T1 / Tp)", "speedup"),
+		(ax_e, fig_e, "Eficiência", "eficiencia"),
+		(ax_k, fig_k, "Fração serial (Karp-Flatt)", "karp_flatt"),
+	):
+		ax.set_title(f"{title}: {suffix.replace('_', '-')}")
+		ax.set_xlabel(x_label)
+		ax.set_ylabel(ylabel)
+		ax.grid(True, linestyle=":", alpha=0.5)
+		ax.legend()
+		fig.tight_layout()
+		fig.savefig(os.path.join(PLOTS_DIR, f"{fname_prefix}_{suffix}.png"))
+		plt.close(fig)
+
+
+def plot_phases(rows, title, fname):
+	"""Barras empilhadas com o tempo de cada fase por configuração (ranks x threads)."""
+	rows = sorted(rows, key=lambda r: (r["ranks"], r["threads"]))
+	labels = [f"{r['ranks']}x{r['threads']}" for r in rows]
+	x = list(range(len(rows)))
+
+	fig, ax = plt.subplots(figsize=(max(6, len(rows) * 0.8), 5))
+	bottom = [0.0] * len(rows)
+	for fase in FASES:
+		values = [r[f"mean_{fase}_s"] for r in rows]
+		ax.bar(x, values, bottom=bottom, label=fase)
+		bottom = [b + v for b, v in zip(bottom, values)]
+	ax.set_xticks(x)
+	ax.set_xticklabels(labels, rotation=45)
+	ax.set_xlabel("Ranks x threads")
+	ax.set_ylabel("Tempo (s, rank mais lento)")
+	ax.set_title(f"{title}: tempo por fase")
+	ax.grid(True, axis="y", linestyle=":", alpha=0.5)
+	ax.legend(title="Fase")
+	fig.tight_layout()
+	fig.savefig(os.path.join(PLOTS_DIR, fname))
+	plt.close(fig)
+
+
+def plot_forte(data):
+	"""Escalabilidade forte — um conjunto de gráficos por (grid, agentes)."""
+	data_f = [r for r in data if r["modo"] == "forte"]
+	by_problem = defaultdict(list)
+	for r in data_f:
+		by_problem[(r["largura"], r["altura"], r["agentes"])].append(r)
+
+	for (largura, altura, agentes), rows in by_problem.items():
+		base_rows = [r for r in rows if r["pes"] == 1]
+		if not base_rows:
+			print(f"[AVISO] Sem ponto 1 rank x 1 thread para {largura}x{altura}, {agentes} agentes; pulando.")
+			continue
+		title = f"Forte – grid {largura}x{altura}, {agentes} agentes"
+		prefix = f"forte_{largura}x{altura}_A{agentes}"
+		plot_scaling(rows, base_rows[0]["mean_total_s"], title, prefix, scaled=False)
+		plot_phases(rows, title, f"{prefix}_fases.png")
+
+
+def plot_fraca(data):
+	"""Escalabilidade fraca — trabalho constante por rank."""
+	data_w = [r for r in data if r["modo"] == "fraca"]
+	if not data_w:
+		return
+	title = "Fraca – trabalho constante por rank"
+	plot_scaling(data_w, None, title, "fraca", scaled=True)
+	plot_phases(data_w, title, "fraca_fases.png")
+
+
+def main():
+	if not os.path.exists(RESULTS_CSV):
+		print(f"[ERRO] Arquivo de resultados não encontrado: {RESULTS_CSV}")
+		print("Execute primeiro ./run.sh para gerar o CSV.")
+		return
+
+	ensure_outdir()
+	data = load_results(RESULTS_CSV)
+
+	plot_forte(data)
+	plot_fraca(data)
+
+	print(f"Gráficos gerados em '{PLOTS_DIR}/'.")
+
+
+if __name__ == "__main__":
+	main()
@@ -0,0 +1,252 @@
+#!/usr/bin/env bash
+
+set -euo pipefail
+
+# Benchmark de escalabilidade do trabalho2 (MPI + OpenMP)
+#
+# Função:
+#   - varrer a matriz ranks MPI x threads OpenMP x tamanho do grid x número de agentes
+#   - escalabilidade FORTE: problema fixo, mais ranks/threads
+#   - escalabilidade FRACA: trabalho constante por rank (a altura do grid e os agentes crescem
+#     junto com o número de ranks; a largura fica fixa, então cada faixa tem o mesmo tamanho)
+#   - executar cada ponto REPS vezes e calcular média e desvio-padrão do tempo total e de cada fase
+#   - gravar tudo em um único CSV para uso pelo plot.py
+#
+# Pensado para uma única máquina Linux multicore: os ranks são locais e, se ranks x threads
+# passar do número de núcleos, rodam sobrepostos (--oversubscribe, sem fixação em núcleos).
+# Para outro MPI, ajuste MPIRUN e MPIRUN_FLAGS (ex.: MPICH: MPIRUN_FLAGS="").
+#
+# CONVENÇÕES DO PROGRAMA:
+#   - Executável em bin/trabalho2 (build de produção do Makefile, feito aqui se ainda não existir);
+#     BIN=./bin/trabalho2_native ./run.sh mede outra variante
+#   - Tamanho do problema pela linha de comando:
+#       trabalho2 --largura L --altura A --agentes N --ciclos C
+#     (a altura precisa ser múltipla do número de ranks; pontos inválidos são pulados)
+#   - Threads via variável de ambiente OMP_NUM_THREADS
+#   - Ao final, o rank 0 imprime o tempo do rank mais lento, total e por fase:
+#       TOTAL_SECONDS=  HALO_SECONDS=  AGENTES_SECONDS=  MIGRACAO_SECONDS=
+#       RECURSOS_SECONDS=  METRICAS_SECONDS=  INICIALIZACAO_SECONDS=
+#
+# Uso:
+#   ./run.sh              # forte e fraca
+#   ./run.sh forte        # só escalabilidade forte (ou: ./run.sh fraca)
+#   REPS=5 RANKS="1 2 4 8" THREADS="1 2" ./run.sh
+
+cd "$(dirname "$0")"
+
+REPS=${REPS:-3}     # número de repetições por ponto da matriz
+CICLOS=${CICLOS:-20}
+
+read -r -a RANKS <<< "${RANKS:-1 2 4}"
+read -r -a THREADS <<< "${THREADS:-1 2 4}"
+
+# Escalabilidade forte: grids (LARGURAxALTURA) e populações fixas
+GRIDS_FORTE=("500x500" "1000x1000")
+AGENTES_FORTE=(50000 100000)
+
+# Escalabilidade fraca: trabalho por rank
+LARGURA_FRACA=1000
+ALTURA_POR_RANK=125
+AGENTES_POR_RANK=12500
+
+MPICXX=${MPICXX:-mpic++}
+MPIRUN=${MPIRUN:-mpirun}
+MPIRUN_FLAGS=${MPIRUN_FLAGS:---oversubscribe --bind-to none}
+BIN=${BIN:-./bin/trabalho2}
+
+OUTPUT_DIR="results"
+mkdir -p "${OUTPUT_DIR}"
+CSV_FILE="${OUTPUT_DIR}/results.csv"
+FASES=(halo agentes migracao recursos metricas)
+
+# Cabeçalho do CSV (só escreve se o arquivo ainda não existir ou estiver vazio)
+if [[ ! -f "${CSV_FILE}" || ! -s "${CSV_FILE}" ]]; then
+    echo "modo,ranks,threads,largura,altura,agentes,ciclos,mean_total_s,std_total_s,mean_halo_s,mean_agentes_s,mean_migracao_s,mean_recursos_s,mean_metricas_s" >"${CSV_FILE}"
+fi
+
+###############################################################################
+# Funções auxiliares: média e desvio-padrão
+###############################################################################
+
+compute_mean() {
+    local values=("$@")
+    local n=${#values[@]}
+
+    if (( n == 0 )); then
+        echo "0.0"
+        return
+    fi
+
+    for v in "${values[@]}"; do echo "${v}"; done | awk '{s += $1} END {if (NR > 0) printf "%.9f", s/NR; else print "0.0"}'
+}
+
+compute_std() {
+    local mean="$1"; shift
+    local values=("$@")
+    local n=${#values[@]}
+
+    if (( n <= 1 )); then
+        echo "0.0"
+        return
+    fi
+
+    for v in "${values[@]}"; do echo "${v}"; done | awk -v m="${mean}" -v n="${n}" '{d = $1 - m; sq += d * d} END {printf "%.9f", sqrt(sq/(n-1))}'
+}
+
+###############################################################################
+# Compilação (se necessário)
+###############################################################################
+
+build_if_needed() {
+    if [[ -x "${BIN}" ]]; then
+        return
+    fi
+    echo "[INFO] Compilando ${BIN} (make, com ${MPICXX})" >&2
+    make "${BIN#./}" MPICXX="${MPICXX}" MPIRUN="${MPIRUN}" >&2
+}
+
+###############################################################################
+# Controle de reexecução (retomar de onde parou)
+###############################################################################
+
+declare -A DONE_POINTS=()
+
+load_done_points() {
+    # Marca os pontos já presentes no CSV, para não repetir experimentos
+    local first=1
+    while IFS=, read -r modo ranks threads largura altura agentes ciclos _; do
+        if (( first )); then
+            first=0
+            continue
+        fi
+        DONE_POINTS["${modo}|${ranks}|${threads}|${largura}|${altura}|${agentes}|${ciclos}"]=1
+    done < "${CSV_FILE}"
+}
+
+###############################################################################
+# Função genérica: roda um ponto da matriz e grava no CSV
+###############################################################################
+
+run_experiment_point() {
+    local modo="$1"     # forte ou fraca
+    local ranks="$2"
+    local threads="$3"
+    local largura="$4"
+    local altura="$5"
+    local agentes="$6"
+
+    local key="${modo}|${ranks}|${threads}|${largura}|${altura}|${agentes}|${CICLOS}"
+    if [[ ${DONE_POINTS["${key}"]+_} ]]; then
+        echo "[INFO] Pulando ${modo} ranks=${ranks} threads=${threads} grid=${largura}x${altura} agentes=${agentes} (já no CSV)" >&2
+        return
+    fi
+    if (( altura % ranks != 0 )); then
+        echo "[AVISO] Altura ${altura} não é múltipla de ${ranks} ranks; pulando ponto." >&2
+        return
+    fi
+
+    echo "[INFO] ${modo}: ranks=${ranks} threads=${threads} grid=${largura}x${altura} agentes=${agentes}" >&2
+
+    local total_values=()
+    declare -A fase_values=()
+
+    for ((rep = 1; rep <= REPS; rep++)); do
+        local output
+        # shellcheck disable=SC2086
+        if ! output="$(OMP_NUM_THREADS="${threads}" ${MPIRUN} ${MPIRUN_FLAGS} -np "${ranks}" "${BIN}" \
+                --largura "${largura}" --altura "${altura}" --agentes "${agentes}" --ciclos "${CICLOS}" 2>&1)"; then
+            echo "[ERRO] Execução falhou: ${modo} ranks=${ranks} threads=${threads} grid=${largura}x${altura} agentes=${agentes}" >&2
+            echo "${output}" | tail -n 20 >&2
+            exit 1
+        fi
+
+        local total
+        total=$(echo "${output}" | awk -F= '/^TOTAL_SECONDS=/ {print $2}' | head -n1)
+        if [[ -z "${total}" ]]; then
+            echo "[ERRO] Não consegui extrair TOTAL_SECONDS do output." >&2
+            echo "${output}" | tail -n 20 >&2
+            exit 1
+        fi
+        total_values+=("${total}")
+
+        for fase in "${FASES[@]}"; do
+            local chave valor
+            chave="$(echo "${fase}" | tr '[:lower:]' '[:upper:]')_SECONDS"
+            valor=$(echo "${output}" | awk -F= -v k="${chave}" '$1 == k {print $2}' | head -n1)
+            fase_values["${fase}"]+="${valor:-0} "
+        done
+    done
+
+    local mean_total std_total
+    mean_total=$(compute_mean "${total_values[@]}")
+    std_total=$(compute_std "${mean_total}" "${total_values[@]}")
+
+    local linha="${modo},${ranks},${threads},${largura},${altura},${agentes},${CICLOS},${mean_total},${std_total}"
+    for fase in "${FASES[@]}"; do
+        local valores
+        read -r -a valores <<< "${fase_values[${fase}]}"
+        linha+=",$(compute_mean "${valores[@]}")"
+    done
+    echo "${linha}" >>"${CSV_FILE}"
+}
+
+###############################################################################
+# Escalabilidade forte — problema fixo
+###############################################################################
+
+run_forte() {
+    for grid in "${GRIDS_FORTE[@]}"; do
+        local largura="${grid%x*}"
+        local altura="${grid#*x}"
+        for agentes in "${AGENTES_FORTE[@]}"; do
+            for ranks in "${RANKS[@]}"; do
+                for threads in "${THREADS[@]}"; do
+                    run_experiment_point "forte" "${ranks}" "${threads}" "${largura}" "${altura}" "${agentes}"
+                done
+            done
+        done
+    done
+}
+
+###############################################################################
+# Escalabilidade fraca — trabalho constante por rank
+###############################################################################
+
+run_fraca() {
+    for ranks in "${RANKS[@]}"; do
+        for threads in "${THREADS[@]}"; do
+            run_experiment_point "fraca" "${ranks}" "${threads}" "${LARGURA_FRACA}" \
+                "$(( ALTURA_POR_RANK * ranks ))" "$(( AGENTES_POR_RANK * ranks ))"
+        done
+    done
+}
+
+###############################################################################
+# Ponto de entrada
+###############################################################################
+
+main() {
+    local modos=()
+    if (( $# > 0 )); then
+        modos=("$@")
+    else
+        modos=(forte fraca)
+    fi
+
+    build_if_needed
+    load_done_points
+
+    for m in "${modos[@]}"; do
+        case "${m}" in
+            forte) run_forte ;;
+            fraca) run_fraca ;;
+            *)
+                echo "[AVISO] Modo desconhecido: ${m} (use forte ou fraca)" >&2
+                ;;
+        esac
+    done
+
+    echo "Resultados salvos em ${CSV_FILE}"
+}
+
+main "$@"
@@ -1,70 +1,79 @@
 #include "agente.hpp"
 #include "config.hpp"
+#include "piramide.hpp"
 #include <cmath>
 #include <cstdlib>
+#include <omp.h>
 
 Agente::Agente(Posicao inicial, float energia_inicial)
     : pos(inicial), energia(energia_inicial) {}
 
-void Agente::executar_carga(float recurso_local) {
-    // O custo é proporcional ao recurso local (quanto mais recurso, mais trabalho para processar/decidir)
-    int custo = static_cast<int>(recurso_local * Config::FATOR_CARGA_TRABALHO);
-    if (custo > Config::MAX_CUSTO) {
-        custo = Config::MAX_CUSTO;
-    }
-
+void carga_sintetica(int custo) {
     // Processamento computacional arbitrário (útil para analisar OpenMP overhead)
     volatile double dummy = 0.0;
     for (int i = 0; i < custo; ++i) {
         dummy += std::sin(static_cast<double>(i)) * std::cos(static_cast<double>(i));
     }
+}
+
+void Agente::executar_carga(float recurso_local) {
+    // O custo é proporcional ao recurso local (quanto mais recurso, mais trabalho para processar/decidir)
+    int custo = custo_carga(recurso_local, Regras::atuais.fator_carga_trabalho);
+
+    if (Config::CARGA_SINTETICA) {
+        carga_sintetica(custo);
+    }
 
     // Gasto de energia: 
     // 1. Custo metabólico fixo - Aumentado para maior rigor
     // 2. Gasto proporcional ao esforço da carga sintética - Peso aumentado
-    float custo_esforco = custo * Config::TAXA_CUSTO_ESFORCO;
-    
-    this->energia -= (Config::CUSTO_METABOLICO + custo_esforco);
+    this->energia -= gasto_energia(custo);
+}
+
+namespace {
+    constexpr const int (&DX)[8] = TabelasTerritorio::VIZINHO_DX;
+    constexpr const int (&DY)[8] = TabelasTerritorio::VIZINHO_DY;
+
+    // Linhas da tabela de acessibilidade estendida centradas na posição global do agente
+    inline const TabelasTerritorio::PeriodoEstendido& acesso_da_estacao(Estacao estacao) {
+        return TabelasTerritorio::ACESSO_VIZINHANCA[static_cast<int>(estacao)];
+    }
 }
 
 bool Agente::reproduzir(const Territorio& grid_local, Agente& filho) {
     // Verifica condição de reprodução
-    if (energia <= Config::THRESHOLD_REPRODUCAO) {
+    if (energia <= Regras::atuais.threshold_reproducao) {
         return false;
     }
 
-    // Converte posição global para referencial local
+    // Converte posição global para referencial local (o agente sempre vive dentro do subgrid)
     int local_x = pos.x - grid_local.get_offset().x;
     int local_y = pos.y - grid_local.get_offset().y;
 
-    // Varredura da vizinhança de Moore para encontrar a célula adjacente
-    // acessível com mais recurso (ignora halos: filho nasce dentro do subgrid)
-    int dx[] = {-1,  0,  1, -1, 1, -1, 0, 1};
-    int dy[] = {-1, -1, -1,  0, 0,  1, 1, 1};
+    // Estêncil sem desvios sobre a grade com anel fantasma: cada vizinho vale o seu recurso se
+    // for acessível e estiver numa linha própria (o filho nasce dentro do subgrid, nunca no halo),
+    // senão RECURSO_FANTASMA. As colunas fora do subgrid já guardam a sentinela.
+    const float* centro = grid_local.ptr_recurso(Posicao(local_x, local_y));
+    const int passo = grid_local.get_passo();
+    const auto& acesso = acesso_da_estacao(grid_local.get_estacao());
+    const int px = pos.x % TabelasTerritorio::PERIODO_X + 1;
+    const int py = pos.y % TabelasTerritorio::PERIODO_Y + 1;
+    const unsigned altura = (unsigned)grid_local.get_altura();
 
-    Posicao melhor_pos = pos; // Padrão: manter posição (fallback)
-    float melhor_recurso = -1.0f;
-    bool encontrou_vizinho = false;
+    float melhor_recurso = Territorio::RECURSO_FANTASMA;
+    int escolhido = -1;
 
     for (int i = 0; i < 8; ++i) {
-        int lnx = local_x + dx[i];
-        int lny = local_y + dy[i];
-
-        // Apenas células dentro do subgrid local (sem halos)
-        if (lnx >= 0 && lnx < grid_local.get_largura() &&
-            lny >= 0 && lny < grid_local.get_altura()) {
-            
-            const Celula& vizinha = grid_local.get_celula(Posicao(lnx, lny));
-            if (vizinha.acessivel && vizinha.recurso > melhor_recurso) {
-                melhor_recurso = vizinha.recurso;
-                melhor_pos = Posicao(pos.x + dx[i], pos.y + dy[i]); // Posição global
-                encontrou_vizinho = true;
-            }
-        }
+        float recurso = centro[DY[i] * passo + DX[i]];
+        bool valido = acesso[py + DY[i]][px + DX[i]] && (unsigned)(local_y + DY[i]) < altura;
+        float candidato = valido ? recurso : Territorio::RECURSO_FANTASMA;
+        bool melhora = candidato > melhor_recurso;
+        melhor_recurso = melhora ? candidato : melhor_recurso;
+        escolhido = melhora ? i : escolhido;
     }
 
     // Só reproduz se houver alguma célula adjacente acessível
-    if (!encontrou_vizinho) {
+    if (escolhido < 0) {
         return false;
     }
 
@@ -73,7 +82,7 @@ bool Agente::reproduzir(const Territorio& grid_local, Agente& filho) {
     this->energia -= energia_transferida;
 
     // Cria o filho na melhor posição adjacente com a energia transferida
-    filho = Agente(melhor_pos, energia_transferida);
+    filho = Agente(Posicao(pos.x + DX[escolhido], pos.y + DY[escolhido]), energia_transferida);
     return true;
 }
 
@@ -81,53 +90,43 @@ void Agente::decidir(const Territorio& grid_local, Posicao& dest) const {
     // Algoritmo local de decisão:
     // Agente verifica células vizinhas acessíveis e com maior recurso disponível.
     // O destino padrão inicialmente é a própria posição.
-    dest = pos;
 
     // Converte sua posição global atual para o referencial local da grade
+    // (o agente sempre vive dentro do subgrid; os vizinhos podem cair no anel fantasma)
     int local_x = pos.x - grid_local.get_offset().x;
     int local_y = pos.y - grid_local.get_offset().y;
 
-    // Uma heurística inicial simplista visando a máxima quantidade de recursos (vizinhança Moore)
-    int dx[] = {-1,  0,  1, -1, 1, -1, 0, 1};
-    int dy[] = {-1, -1, -1,  0, 0,  1, 1, 1};
-    
+    // Uma heurística inicial simplista visando a máxima quantidade de recursos (vizinhança Moore).
+    // Max-redução em linha reta sobre os 8 vizinhos: os halos estão no lugar (linhas fantasmas) e
+    // as bordas do grid global valem RECURSO_FANTASMA, então não há testes de limites; os recursos
+    // vêm do plano corrente e a acessibilidade da tabela estendida (um módulo por eixo, feito uma vez).
+    const float* centro = grid_local.ptr_recurso(Posicao(local_x, local_y));
+    const int passo = grid_local.get_passo();
+    const auto& acesso = acesso_da_estacao(grid_local.get_estacao());
+    const int px = pos.x % TabelasTerritorio::PERIODO_X + 1;
+    const int py = pos.y % TabelasTerritorio::PERIODO_Y + 1;
+
     // Identificação do melhor recurso atual (célula onde está no momento)
-    float melhor_recurso = -1.0f;
-    if (local_x >= 0 && local_x < grid_local.get_largura() && 
-        local_y >= 0 && local_y < grid_local.get_altura()) {
-        melhor_recurso = grid_local.get_celula(Posicao(local_x, local_y)).recurso;
-    }
+    float melhor_recurso = *centro;
+    int escolhido = -1;
 
     for (int i = 0; i < 8; ++i) {
-        int nx = pos.x + dx[i]; // Global adjacente X
-        int ny = pos.y + dy[i]; // Global adjacente Y
-        
-        // Relacionado ao grid e ao offset
-        int lnx = nx - grid_local.get_offset().x;
-        int lny = ny - grid_local.get_offset().y;
-
-        bool is_valid = false;
-        Celula vizinha;
-
-        if (lnx >= 0 && lnx < grid_local.get_largura()) {
-            if (lny >= 0 && lny < grid_local.get_altura()) {
-                vizinha = grid_local.get_celula(Posicao(lnx, lny));
-                is_valid = true;
-            } else if (lny == -1 && grid_local.tem_halo_sup()) {
-                vizinha = grid_local.get_halo_sup(lnx);
-                is_valid = true;
-            } else if (lny == grid_local.get_altura() && grid_local.tem_halo_inf()) {
-                vizinha = grid_local.get_halo_inf(lnx);
-                is_valid = true;
-            }
-        }
+        float recurso = centro[DY[i] * passo + DX[i]];
+        float candidato = acesso[py + DY[i]][px + DX[i]] ? recurso : Territorio::RECURSO_FANTASMA;
+        bool melhora = candidato > melhor_recurso;
+        melhor_recurso = melhora ? candidato : melhor_recurso;
+        escolhido = melhora ? i : escolhido;
+    }
 
-        if (is_valid && vizinha.acessivel && vizinha.recurso > melhor_recurso) {
-            melhor_recurso = vizinha.recurso;
-            dest.x = nx;
-            dest.y = ny;
-        }
+    // Percepção estendida: com pouco recurso na célula, o agente segue o ladrilho vizinho mais
+    // rico da pirâmide (se a célula nessa direção for acessível) em vez do máximo de Moore
+    const PiramideRecursos* piramide = grid_local.get_piramide();
+    if (Config::PERCEPCAO_ESTENDIDA && piramide && *centro < Config::LIMIAR_PERCEPCAO_ESTENDIDA) {
+        int d = piramide->direcao(pos.x, pos.y);
+        if (d >= 0 && acesso[py + DY[d]][px + DX[d]]) escolhido = d;
     }
+
+    dest = (escolhido < 0) ? pos : Posicao(pos.x + DX[escolhido], pos.y + DY[escolhido]);
 }
 
 float Agente::consumir_recurso(Territorio& grid_local) {
@@ -142,7 +141,7 @@ float Agente::consumir_recurso(Territorio& grid_local) {
         local_y >= 0 && local_y < grid_local.get_altura()) {
 
         // Consome limitando à quantidade total que a célula possui no momento
-        float recurso_disponivel = grid_local.get_celula(Posicao(local_x, local_y)).recurso;
+        float recurso_disponivel = grid_local.get_recurso(Posicao(local_x, local_y));
         float consumo_real = (recurso_disponivel >= recurso_requerido) ? recurso_requerido : recurso_disponivel;
 
         // Avisa à grade local que aquele conteúdo foi removido.
@@ -157,3 +156,77 @@ float Agente::consumir_recurso(Territorio& grid_local) {
 
     return 0.0f; // Se fora do grid não tem acesso ao recurso para este processo
 }
+
+void agrupar_agentes_por_faixa(VetorAgentes& agentes, VetorAgentes& auxiliar, std::vector<int>& cursor,
+                               std::vector<int>& inicio_faixa, const Territorio& grid_local,
+                               VetorIds* ids, VetorIds* auxiliar_ids) {
+    #pragma omp parallel
+    agrupar_agentes_por_faixa_na_regiao(agentes, auxiliar, cursor, inicio_faixa, grid_local, ids, auxiliar_ids);
+}
+
+void agrupar_agentes_por_faixa_na_regiao(VetorAgentes& agentes, VetorAgentes& auxiliar, std::vector<int>& cursor,
+                                         std::vector<int>& inicio_faixa, const Territorio& grid_local,
+                                         VetorIds* ids, VetorIds* auxiliar_ids) {
+    // cursor: [thread de origem][faixa], contagem e depois posição de escrita
+    int offset_y = grid_local.get_offset().y;
+    int num_faixas = omp_get_num_threads();
+    int t = omp_get_thread_num();
+
+    // Sem inicialização: cada página do destino é tocada pela thread dona da faixa
+    #pragma omp single
+    {
+        auxiliar.resize(agentes.size());
+        if (ids) auxiliar_ids->resize(ids->size());
+        cursor.assign((size_t)num_faixas * num_faixas, 0);
+        inicio_faixa.assign(num_faixas + 1, 0);
+    }
+    int n = (int)agentes.size();
+
+    // 1. Contagem por faixa sobre o bloco estático de origem desta thread
+    int ini = (int)((long long)n * t / num_faixas);
+    int fim = (int)((long long)n * (t + 1) / num_faixas);
+    int* meu_cursor = &cursor[(size_t)t * num_faixas];
+    for (int i = ini; i < fim; ++i) {
+        meu_cursor[grid_local.faixa_da_linha(agentes[i].get_posicao().y - offset_y, num_faixas)]++;
+    }
+
+    // 2. Soma de prefixos (faixa, origem): define onde cada thread escreve cada faixa
+    #pragma omp barrier
+    #pragma omp single
+    {
+        int pos = 0;
+        for (int f = 0; f < num_faixas; ++f) {
+            inicio_faixa[f] = pos;
+            for (int o = 0; o < num_faixas; ++o) {
+                int c = cursor[(size_t)o * num_faixas + f];
+                cursor[(size_t)o * num_faixas + f] = pos;
+                pos += c;
+            }
+        }
+        inicio_faixa[num_faixas] = pos;
+    }
+
+    // 3. First-touch: a dona da faixa escreve primeiro cada página da sua região
+    //    (só tem efeito em páginas recém-alocadas, mas é barato: um elemento por página)
+    constexpr int ELEMENTOS_POR_PAGINA = 4096 / sizeof(Agente) > 0 ? 4096 / sizeof(Agente) : 1;
+    for (int i = inicio_faixa[t]; i < inicio_faixa[t + 1]; i += ELEMENTOS_POR_PAGINA) {
+        auxiliar[i] = Agente();
+        if (ids) (*auxiliar_ids)[i] = 0;
+    }
+
+    // 4. Espalhamento estável para as posições calculadas (os ids vão para a mesma posição)
+    #pragma omp barrier
+    for (int i = ini; i < fim; ++i) {
+        int f = grid_local.faixa_da_linha(agentes[i].get_posicao().y - offset_y, num_faixas);
+        int destino = meu_cursor[f]++;
+        auxiliar[destino] = agentes[i];
+        if (ids) (*auxiliar_ids)[destino] = (*ids)[i];
+    }
+
+    #pragma omp barrier
+    #pragma omp single
+    {
+        agentes.swap(auxiliar);
+        if (ids) ids->swap(*auxiliar_ids);
+    }
+}
@@ -1,8 +1,30 @@
 #ifndef AGENTE_HPP
 #define AGENTE_HPP
 
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
 #include "territorio.hpp"
 #include "posicao.hpp"
+#include "config.hpp"
+#include "regras.hpp"
+
+// Custo (em iterações) da carga sintética de um agente sobre uma célula com `recurso_local`
+// (`fator_carga`: RegrasCenario::fator_carga_trabalho)
+inline int custo_carga(float recurso_local, float fator_carga) {
+    int custo = static_cast<int>(recurso_local * fator_carga);
+    return custo > Config::MAX_CUSTO ? Config::MAX_CUSTO : custo;
+}
+
+// Energia gasta no ciclo: custo metabólico fixo + esforço proporcional à carga
+inline float gasto_energia(int custo) {
+    float custo_esforco = custo * Config::TAXA_CUSTO_ESFORCO;
+    return Config::CUSTO_METABOLICO + custo_esforco;
+}
+
+// Executa `custo` iterações de trabalho sintético (sem efeito no estado da simulação)
+void carga_sintetica(int custo);
 
 // Classe para abstrair os agentes no sistema (grupos familiares indígenas)
 class Agente {
@@ -25,7 +47,7 @@ public:
     // Atualiza a energia do agente (usado na reprodução para ceder energia ao filho)
     void set_energia(float e) { energia = e; }
 
-    // Tenta reproduzir o agente caso sua energia supere THRESHOLD_REPRODUCAO.
+    // Tenta reproduzir o agente caso sua energia supere o limiar do cenário (threshold_reproducao).
     // O filho nasce na célula adjacente acessível com mais recurso.
     // O pai transfere FATOR_ENERGIA_REPRODUCAO * sua_energia ao filho e perde esse valor.
     // Retorna true e preenche `filho` se a reprodução ocorreu, false caso contrário.
@@ -44,4 +66,47 @@ public:
     float consumir_recurso(Territorio& grid_local);
 };
 
+// Alocador que NÃO inicializa elementos em resize(n): as páginas de memória só são tocadas
+// quando cada thread escreve sua parte, respeitando a política first-touch (NUMA).
+// Construções com argumentos (push_back, insert, resize(n, valor)) funcionam normalmente.
+template <typename T>
+struct AlocadorPrimeiroToque : std::allocator<T> {
+    template <typename U>
+    struct rebind { using other = AlocadorPrimeiroToque<U>; };
+
+    AlocadorPrimeiroToque() = default;
+    template <typename U>
+    AlocadorPrimeiroToque(const AlocadorPrimeiroToque<U>&) {}
+
+    template <typename U>
+    void construct(U*) {} // Sem inicialização: o primeiro toque fica para quem escrever o elemento
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+};
+
+using VetorAgentes = std::vector<Agente, AlocadorPrimeiroToque<Agente>>;
+
+// Id global de cada agente, num array frio paralelo a VetorAgentes (ver identidade.hpp)
+using IdAgente = uint64_t;
+using VetorIds = std::vector<IdAgente, AlocadorPrimeiroToque<IdAgente>>;
+
+// Reordena os agentes locais por faixa de linhas do subgrid (uma faixa por thread OpenMP, as
+// mesmas do first-touch do Territorio) com um counting sort paralelo estável.
+// Ao final, os agentes da faixa f estão em [inicio_faixa[f], inicio_faixa[f + 1]) e cada thread
+// tocou primeiro a região do vetor que vai processar. `auxiliar` e `cursor` são reaproveitados
+// entre chamadas (vivem na ArenaCiclo). Com `ids` (ids dos agentes, identidade.hpp), os ids
+// recebem a mesma permutação, usando `auxiliar_ids`.
+void agrupar_agentes_por_faixa(VetorAgentes& agentes, VetorAgentes& auxiliar, std::vector<int>& cursor,
+                               std::vector<int>& inicio_faixa, const Territorio& grid_local,
+                               VetorIds* ids = nullptr,
+                               VetorIds* auxiliar_ids = nullptr);
+
+// Mesma reordenação, chamada por todas as threads de uma região paralela já aberta (construções
+// órfãs: single e barreiras ligam-se à região de quem chama). Uma faixa por thread da região.
+void agrupar_agentes_por_faixa_na_regiao(VetorAgentes& agentes, VetorAgentes& auxiliar, std::vector<int>& cursor,
+                                         std::vector<int>& inicio_faixa, const Territorio& grid_local,
+                                         VetorIds* ids = nullptr,
+                                         VetorIds* auxiliar_ids = nullptr);
+
 #endif // AGENTE_HPP
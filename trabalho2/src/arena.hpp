@@ -0,0 +1,91 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <vector>
+#include <cstddef>
+#include "agente.hpp"
+#include "identidade.hpp"
+
+// Arena dos buffers temporários de um ciclo (por rank e por thread).
+//
+// Todos os vetores usados dentro do ciclo vivem aqui e são reiniciados com clear() em vez de
+// destruídos: a capacidade conquistada nos primeiros ciclos é reaproveitada, e em regime
+// permanente o laço principal não faz alocações no heap. Só há realocação quando a população
+// (ou a migração) supera o maior valor já visto, e isso fica registrado no relatório de pico.
+class ArenaCiclo {
+public:
+    // Buffers privados de cada thread OpenMP, alinhados em linha de cache para que os
+    // cabeçalhos dos vetores (atualizados a cada push_back) não sofram false sharing
+    struct alignas(64) BuffersThread {
+        std::vector<Agente> lista_local;
+        std::vector<IdAgente> ids_local;        // Paralela a lista_local (IDS_AGENTES)
+        std::vector<EventoLinhagem> eventos;    // Eventos de linhagem do ciclo (com --linhagem)
+        BlocoIds bloco_ids;                     // Ids de nascimento reservados (não é reiniciado)
+    };
+
+    VetorAgentes nova_lista;            // Agentes que permanecem no rank (consolidados do laço)
+    VetorAgentes auxiliar_faixas;       // Destino do counting sort por faixas
+    std::vector<int> cursor_faixas;     // Contagens/cursores do counting sort por faixas
+    VetorIds novos_ids;                 // Ids de nova_lista, na mesma ordem
+    VetorIds auxiliar_ids;              // Ids de auxiliar_faixas
+    std::vector<EventoLinhagem> eventos_ciclo; // Eventos de linhagem consolidados das threads
+
+private:
+    std::vector<BuffersThread> por_thread;
+
+    size_t pico_bytes;
+    int ciclos_com_crescimento;
+    int ciclos_registrados;
+
+public:
+    ArenaCiclo() : pico_bytes(0), ciclos_com_crescimento(0), ciclos_registrados(0) {}
+
+    // Garante um conjunto de buffers por thread. Deve ser chamado fora da região paralela.
+    void preparar(int num_threads) {
+        if ((int)por_thread.size() < num_threads) por_thread.resize(num_threads);
+    }
+
+    BuffersThread& da_thread(int t) { return por_thread[t]; }
+
+    // Esvazia os buffers mantendo a capacidade (início de cada ciclo)
+    void reiniciar() {
+        nova_lista.clear();
+        novos_ids.clear();
+        eventos_ciclo.clear();
+        for (BuffersThread& b : por_thread) {
+            b.lista_local.clear();
+            b.ids_local.clear();
+            b.eventos.clear();
+        }
+    }
+
+    // Memória reservada pela arena (mais a lista principal de agentes e seus ids, que giram com
+    // nova_lista e novos_ids)
+    size_t bytes_reservados(const VetorAgentes& agentes_locais, const VetorIds* ids_locais) const {
+        size_t total = (nova_lista.capacity() + auxiliar_faixas.capacity() + agentes_locais.capacity()) * sizeof(Agente)
+                     + cursor_faixas.capacity() * sizeof(int)
+                     + (novos_ids.capacity() + auxiliar_ids.capacity() + (ids_locais ? ids_locais->capacity() : 0)) * sizeof(IdAgente)
+                     + eventos_ciclo.capacity() * sizeof(EventoLinhagem);
+        for (const BuffersThread& b : por_thread) {
+            total += b.lista_local.capacity() * sizeof(Agente) + b.ids_local.capacity() * sizeof(IdAgente)
+                   + b.eventos.capacity() * sizeof(EventoLinhagem);
+        }
+        return total;
+    }
+
+    // Atualiza o pico (high-water mark) ao fim do ciclo. O primeiro ciclo é o aquecimento;
+    // a partir dele, qualquer crescimento significa que houve alocação no heap naquele ciclo.
+    void registrar_ciclo(const VetorAgentes& agentes_locais, const VetorIds* ids_locais = nullptr) {
+        size_t bytes = bytes_reservados(agentes_locais, ids_locais);
+        if (bytes > pico_bytes) {
+            if (ciclos_registrados > 0) ciclos_com_crescimento++;
+            pico_bytes = bytes;
+        }
+        ciclos_registrados++;
+    }
+
+    size_t get_pico_bytes() const { return pico_bytes; }
+    int get_ciclos_com_crescimento() const { return ciclos_com_crescimento; }
+};
+
+#endif // ARENA_HPP
@@ -0,0 +1,254 @@
+#include "bloco_temporal.hpp"
+#include "kernel_agentes.hpp"
+#include "comunicacao.hpp"
+#include "rastro.hpp"
+#include <omp.h>
+#include <algorithm>
+
+// A recomputação redundante da sobreposição não reconstrói a pirâmide de recursos por ciclo
+static_assert(!(Config::PERCEPCAO_ESTENDIDA && Config::PROFUNDIDADE_BLOCO_TEMPORAL > 1),
+              "PERCEPCAO_ESTENDIDA não combina com a blocagem temporal");
+
+namespace {
+    // Destino dos resultados do kernel de agentes dentro de uma thread, no modo em blocos.
+    // Migrantes não saem do rank: mudam de faixa dentro do território estendido e seguem na lista
+    // (os que deixam o território estendido caem na região incerta e são descartados).
+    struct SaidaBloco {
+        std::vector<Agente>& lista_local;
+        int linha_min;  // Linhas globais do território estendido: [linha_min, linha_max)
+        int linha_max;
+        int propria_min; // Linhas globais da faixa própria: [propria_min, propria_max)
+        int propria_max;
+        bool propria;   // O kernel está processando a faixa própria (conta as métricas)
+        int migracoes;
+        int mortes;
+        int nascimentos;
+        float energia;  // Energia dos agentes que terminam o ciclo na faixa própria
+
+        void morte() { if (propria) mortes++; }
+        void migrante(Direcao, const Agente& a) {
+            if (propria) migracoes++;
+            int y = a.get_posicao().y;
+            if (y < linha_min || y >= linha_max) return;
+
+            // Mesmo formato (e perda, se quantizado) de um migrante que passou pela rede
+            Agente chegada = a;
+            if (Config::ENERGIA_QUANTIZADA) {
+                unsigned char pacote[FormatoMigracao::BYTES_POR_AGENTE];
+                FormatoMigracao::empacotar(&a, 1, pacote);
+                FormatoMigracao::desempacotar(pacote, 1, y, &chegada);
+            }
+            lista_local.push_back(chegada);
+            if (y >= propria_min && y < propria_max) energia += chegada.get_energia();
+        }
+        void local(const Agente& a) { lista_local.push_back(a); if (propria) energia += a.get_energia(); }
+        void nascimento(const Agente& filho) {
+            lista_local.push_back(filho);
+            if (propria) { nascimentos++; energia += filho.get_energia(); }
+        }
+    };
+}
+
+BlocoTemporal::BlocoTemporal(MPI_Comm comm, int rank, int size, int largura, int altura_faixa, int profundidade,
+                             ArenaCiclo& arena)
+    : comm(comm), rank(rank), size(size), largura(largura), altura_faixa(altura_faixa),
+      halo(3 * profundidade),
+      linhas_sup(rank > 0 ? 3 * profundidade : 0),
+      linhas_inf(rank < size - 1 ? 3 * profundidade : 0),
+      estendido(largura, linhas_sup + altura_faixa + linhas_inf, Posicao(0, rank * altura_faixa - linhas_sup)),
+      faixa_propria(0), arena(arena), sincronizacoes(0) {
+
+    // Uma vista por faixa global que cruza o território estendido (no máximo 3, pois halo <= altura_faixa),
+    // sobre os mesmos planos, `ini - y_inicial` linhas abaixo da primeira linha do estendido
+    int y_inicial = estendido.get_offset().y;
+    int y_final = y_inicial + estendido.get_altura();
+    for (int f = y_inicial / altura_faixa; f * altura_faixa < y_final; ++f) {
+        int ini = std::max(f * altura_faixa, y_inicial);
+        int fim = std::min((f + 1) * altura_faixa, y_final);
+        if (f == rank) faixa_propria = (int)faixas.size();
+        faixas.emplace_back(estendido, ini - y_inicial, fim - ini);
+    }
+
+    MPI_Type_vector(halo, largura, estendido.get_passo(), MPI_FLOAT, &tipo_halo);
+    MPI_Type_commit(&tipo_halo);
+}
+
+BlocoTemporal::~BlocoTemporal() {
+    MPI_Type_free(&tipo_halo);
+}
+
+void BlocoTemporal::inicializar(Estacao estacao_inicial, VetorAgentes agentes_proprios) {
+    // Os halos já nascem corretos (o estado inicial é função da posição global) e as linhas
+    // fantasmas do território estendido recebem as sentinelas
+    estendido.inicializar(estacao_inicial);
+    atualizar_estacao(estacao_inicial);
+
+    agentes.swap(agentes_proprios);
+    agrupar();
+}
+
+void BlocoTemporal::atualizar_estacao(Estacao nova_estacao) {
+    estendido.atualizar_acessibilidade(nova_estacao);
+    for (Territorio& f : faixas) f.atualizar_acessibilidade(nova_estacao);
+}
+
+void BlocoTemporal::agrupar() {
+    int num_faixas = (int)faixas.size();
+    int n = (int)agentes.size();
+    std::vector<int>& cursor = arena.cursor_faixas;
+    cursor.assign(num_faixas + 1, 0);
+
+    for (int i = 0; i < n; ++i) cursor[faixa_da_linha(agentes[i].get_posicao().y) + 1]++;
+    for (int f = 0; f < num_faixas; ++f) cursor[f + 1] += cursor[f];
+    inicio_faixa.assign(cursor.begin(), cursor.end());
+
+    VetorAgentes& auxiliar = arena.auxiliar_faixas;
+    auxiliar.resize(n);
+    for (int i = 0; i < n; ++i) auxiliar[cursor[faixa_da_linha(agentes[i].get_posicao().y)]++] = agentes[i];
+    agentes.swap(auxiliar);
+}
+
+void BlocoTemporal::sincronizar() {
+    // Posse pela posição: só os agentes das linhas próprias estão corretos
+    agentes.erase(agentes.begin() + inicio_faixa[faixa_propria + 1], agentes.end());
+    agentes.erase(agentes.begin(), agentes.begin() + inicio_faixa[faixa_propria]);
+
+    Territorio& propria = faixas[faixa_propria];
+    int y_propria = propria.get_offset().y;
+    std::vector<Agente>& envio_cima = envio[static_cast<int>(Direcao::CIMA)];
+    std::vector<Agente>& envio_baixo = envio[static_cast<int>(Direcao::BAIXO)];
+    envio_cima.clear();
+    envio_baixo.clear();
+    for (const Agente& a : agentes) {
+        int y = a.get_posicao().y - y_propria;
+        if (linhas_sup > 0 && y < halo) envio_cima.push_back(a);
+        if (linhas_inf > 0 && y >= altura_faixa - halo) envio_baixo.push_back(a);
+    }
+
+    // Linhas de borda direto da grade para os halos do vizinho (sem cópia intermediária)
+    MPI_Request reqs[6];
+    int num_reqs = 0;
+    if (linhas_sup > 0) {
+        MPI_Irecv(estendido.ptr_recurso(Posicao(0, 0)), 1, tipo_halo, rank - 1, TAG_CELULAS, comm, &reqs[num_reqs++]);
+        MPI_Isend(propria.ptr_recurso(Posicao(0, 0)), 1, tipo_halo, rank - 1, TAG_CELULAS, comm, &reqs[num_reqs++]);
+        MPI_Isend(envio_cima.data(), (int)(envio_cima.size() * sizeof(Agente)), MPI_BYTE, rank - 1, TAG_AGENTES,
+                  comm, &reqs[num_reqs++]);
+    }
+    if (linhas_inf > 0) {
+        MPI_Irecv(estendido.ptr_recurso(Posicao(0, linhas_sup + altura_faixa)), 1, tipo_halo, rank + 1, TAG_CELULAS,
+                  comm, &reqs[num_reqs++]);
+        MPI_Isend(propria.ptr_recurso(Posicao(0, altura_faixa - halo)), 1, tipo_halo, rank + 1, TAG_CELULAS,
+                  comm, &reqs[num_reqs++]);
+        MPI_Isend(envio_baixo.data(), (int)(envio_baixo.size() * sizeof(Agente)), MPI_BYTE, rank + 1, TAG_AGENTES,
+                  comm, &reqs[num_reqs++]);
+    }
+
+    // Agentes dos vizinhos: o tamanho só é conhecido na chegada (MPI_Probe)
+    int vizinhos[2] = {linhas_sup > 0 ? rank - 1 : MPI_PROC_NULL, linhas_inf > 0 ? rank + 1 : MPI_PROC_NULL};
+    for (int vizinho : vizinhos) {
+        if (vizinho == MPI_PROC_NULL) continue;
+        MPI_Status status;
+        int bytes = 0;
+        MPI_Probe(vizinho, TAG_AGENTES, comm, &status);
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        size_t inicio = agentes.size();
+        agentes.resize(inicio + bytes / sizeof(Agente));
+        MPI_Recv(agentes.data() + inicio, bytes, MPI_BYTE, vizinho, TAG_AGENTES, comm, MPI_STATUS_IGNORE);
+    }
+
+    MPI_Waitall(num_reqs, reqs, MPI_STATUSES_IGNORE);
+    agrupar();
+    sincronizacoes++;
+}
+
+MetricasLocaisCiclo BlocoTemporal::avancar_ciclo(Estacao estacao_atual, TemposFases& tempos) {
+    double marca = omp_get_wtime();
+    arena.reiniciar();
+
+    int linha_min = estendido.get_offset().y;
+    int linha_max = linha_min + estendido.get_altura();
+    int num_faixas = (int)faixas.size();
+    int n = (int)agentes.size();
+    Territorio& propria = faixas[faixa_propria];
+    int propria_min = propria.get_offset().y;
+    int propria_max = propria_min + propria.get_altura();
+    int total_migracoes = 0, total_mortes = 0, total_nascimentos = 0;
+    float energia_total = 0.0f;
+    VetorAgentes& nova_lista = arena.nova_lista;
+
+    // Mesma escolha do modo ciclo a ciclo; aqui as faixas são as globais, não as das threads, e
+    // os estáticos dividem a lista em blocos iguais
+    EstrategiaAgentes estrategia = seletor.escolher(n);
+    bool em_lote = SeletorEstrategia::em_lote(estrategia);
+    int equipe = seletor.equipe(estrategia);
+    arena.preparar(equipe);
+
+    #pragma omp parallel num_threads(equipe) if(equipe > 1) reduction(+:total_migracoes, total_mortes, total_nascimentos, energia_total)
+    {
+        double inicio_thread = omp_get_wtime();
+        int nt = omp_get_num_threads();
+        int t = omp_get_thread_num();
+
+        std::vector<Agente>& lista_local_thread = arena.da_thread(t).lista_local;
+        SaidaBloco saida{lista_local_thread, linha_min, linha_max, propria_min, propria_max, false, 0, 0, 0, 0.0f};
+
+        // Um trecho pode cruzar faixas: cada pedaço roda com as regras da sua faixa
+        auto rodar = [&](int ini, int fim) {
+            for (int f = 0; f < num_faixas; ++f) {
+                int a = std::max(ini, inicio_faixa[f]);
+                int b = std::min(fim, inicio_faixa[f + 1]);
+                if (a >= b) continue;
+                saida.propria = (f == faixa_propria);
+                if (em_lote) {
+                    processar_lote_agentes(agentes.data() + a, b - a, faixas[f], saida);
+                } else {
+                    for (int i = a; i < b; ++i) processar_agente_escalar(agentes[i], faixas[f], saida);
+                }
+            }
+        };
+
+        if (estrategia == EstrategiaAgentes::DINAMICA) {
+            #pragma omp for schedule(dynamic, 1) nowait
+            for (int p = 0; p < n; p += Config::AGENTES_POR_PEDACO_DINAMICO) {
+                rodar(p, std::min(n, p + Config::AGENTES_POR_PEDACO_DINAMICO));
+            }
+        } else {
+            rodar((int)((long long)n * t / nt), (int)((long long)n * (t + 1) / nt));
+        }
+        total_migracoes += saida.migracoes;
+        total_mortes += saida.mortes;
+        total_nascimentos += saida.nascimentos;
+        energia_total += saida.energia;
+        double fim_thread = omp_get_wtime();
+        seletor.registrar_thread(t, fim_thread - inicio_thread);
+        Rastro::registrar("agentes_thread", inicio_thread, fim_thread);
+
+        #pragma omp critical
+        {
+            nova_lista.insert(nova_lista.end(), lista_local_thread.begin(), lista_local_thread.end());
+        }
+    }
+
+    double tempo_agentes = Rastro::fechar_fase("agentes", marca);
+    tempos.agentes += tempo_agentes;
+    seletor.concluir(estrategia, n, equipe);
+
+    // Uma varredura do território estendido; consumo e recursos contabilizados só na faixa própria
+    marca = omp_get_wtime();
+    BalancoRecursos balanco = estendido.atualizar_recursos_com_balanco(estacao_atual, linhas_sup, linhas_sup + altura_faixa);
+    for (Territorio& f : faixas) f.seguir_plano(estendido);
+    float regeneracao = propria.get_regeneracao_total(estacao_atual);
+    tempos.recursos += Rastro::fechar_fase("recursos", marca);
+
+    // Migrantes já estão na lista: resta reagrupar por faixa
+    marca = omp_get_wtime();
+    agentes.swap(nova_lista);
+    agrupar();
+    arena.registrar_ciclo(agentes);
+    tempos.migracao += Rastro::fechar_fase("migracao", marca);
+
+    // Métricas já coletadas pelo laço de agentes e pela atualização do grid
+    return MetricasLocaisCiclo{inicio_faixa[faixa_propria + 1] - inicio_faixa[faixa_propria], balanco.recursos,
+                               balanco.consumo, regeneracao, total_migracoes, total_mortes, total_nascimentos,
+                               energia_total, (int)estrategia, (float)tempo_agentes};
+}
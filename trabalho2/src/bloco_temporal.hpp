@@ -0,0 +1,95 @@
+#ifndef BLOCO_TEMPORAL_HPP
+#define BLOCO_TEMPORAL_HPP
+
+#include <deque>
+#include <vector>
+#include <mpi.h>
+#include "agente.hpp"
+#include "territorio.hpp"
+#include "arena.hpp"
+#include "metricas.hpp"
+#include "estrategia_agentes.hpp"
+
+// Blocagem temporal: o rank sincroniza com os vizinhos uma vez a cada `profundidade` (k) ciclos,
+// em vez de trocar halo e migrantes em todo ciclo.
+//
+// A cada ciclo um agente anda no máximo uma célula, mas o que acontece numa linha depende de até
+// 3 linhas de distância (decisão lê y ± 1 e o filho nasce a ± 1 do destino). Depois de k ciclos
+// sem comunicação, o estado de uma linha depende portanto do estado inicial num raio de 3k
+// linhas. Cada rank mantém um território estendido com halos de H = 3k linhas de cada lado
+// e, na sincronização, recebe dos vizinhos as H linhas de borda deles e os agentes que vivem
+// nelas. Nos k ciclos seguintes ele recalcula de forma redundante a região de sobreposição; os
+// erros que entram pelas bordas do território estendido (linhas e agentes desconhecidos) avançam
+// no máximo 3 linhas por ciclo e não chegam às linhas próprias antes da próxima sincronização.
+//
+// As regras dependem da faixa a que o agente pertence (migrante não consome no ciclo em que
+// cruza a fronteira; o filho nasce nas linhas da própria faixa). Por isso o território estendido
+// é visto como uma sequência de Territorios-vista, um por faixa global que ele cruza, montados
+// sobre a mesma memória: as linhas da faixa vizinha servem de halo no lugar e os kernels de
+// agentes se aplicam sem mudança. O resultado nas linhas próprias é idêntico ao ciclo a ciclo.
+//
+// Na sincronização a posse volta a ser pela posição: o rank fica só com os agentes das suas
+// linhas (os demais foram recalculados pelo dono). Migração, mortes e nascimentos são contados
+// apenas para a faixa própria, de modo que as métricas somadas entre ranks não se repetem.
+class BlocoTemporal {
+private:
+    static constexpr int TAG_CELULAS = 20;
+    static constexpr int TAG_AGENTES = 21;
+
+    MPI_Comm comm;
+    int rank;
+    int size;
+    int largura;
+    int altura_faixa;   // Altura de todas as faixas globais (uma por rank)
+    int halo;           // Linhas de halo de cada lado (3 * profundidade)
+    int linhas_sup;     // Linhas do vizinho de cima no território estendido (0 ou halo)
+    int linhas_inf;     // Linhas do vizinho de baixo no território estendido (0 ou halo)
+
+    Territorio estendido;          // Faixa própria + halos profundos, com o anel fantasma
+    std::deque<Territorio> faixas; // Vistas por faixa global sobre a memória de `estendido`
+    int faixa_propria;             // Índice da faixa do rank em `faixas`
+
+    MPI_Datatype tipo_halo; // `halo` linhas consecutivas do plano de recurso (sem as colunas fantasmas)
+
+    ArenaCiclo& arena;
+    SeletorEstrategia seletor;     // Forma do laço de agentes em cada ciclo
+    VetorAgentes agentes;          // Agentes do território estendido, agrupados por faixa
+    std::vector<int> inicio_faixa; // Agentes da faixa f em [inicio_faixa[f], inicio_faixa[f + 1])
+    std::vector<Agente> envio[2];  // Agentes próprios nas linhas de borda (para cima / para baixo)
+    long long sincronizacoes;
+
+    int faixa_da_linha(int y_global) const {
+        return y_global / altura_faixa - faixas.front().get_offset().y / altura_faixa;
+    }
+
+    // Counting sort dos agentes por faixa (preenche inicio_faixa)
+    void agrupar();
+
+public:
+    // `profundidade` é o número de ciclos entre sincronizações (3 * profundidade não pode passar
+    // de `altura_faixa`)
+    BlocoTemporal(MPI_Comm comm, int rank, int size, int largura, int altura_faixa, int profundidade,
+                  ArenaCiclo& arena);
+    ~BlocoTemporal();
+
+    BlocoTemporal(const BlocoTemporal&) = delete;
+    BlocoTemporal& operator=(const BlocoTemporal&) = delete;
+
+    // Estado inicial: grade do território estendido e os agentes próprios
+    void inicializar(Estacao estacao_inicial, VetorAgentes agentes_proprios);
+
+    void atualizar_estacao(Estacao nova_estacao);
+
+    // Troca com os vizinhos as `halo` linhas de borda e os agentes que vivem nelas
+    void sincronizar();
+
+    // Um ciclo completo sobre o território estendido, sem comunicação. Retorna as métricas da
+    // faixa própria e acumula o tempo de cada fase em `tempos`.
+    MetricasLocaisCiclo avancar_ciclo(Estacao estacao_atual, TemposFases& tempos);
+
+    int get_halo() const { return halo; }
+    long long get_sincronizacoes() const { return sincronizacoes; }
+    const VetorAgentes& get_agentes() const { return agentes; }
+};
+
+#endif // BLOCO_TEMPORAL_HPP
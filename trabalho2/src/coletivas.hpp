@@ -0,0 +1,31 @@
+#ifndef COLETIVAS_HPP
+#define COLETIVAS_HPP
+
+#include <mpi.h>
+#include <type_traits>
+#include <vector>
+
+// Junta no rank 0 de `comm` os vetores de todos os ranks, concatenados na ordem dos ranks (cada
+// um com o seu tamanho). Os elementos trafegam como bytes: primeiro o tamanho de cada rank, depois
+// os dados. Nos demais ranks o resultado fica vazio.
+template <typename T>
+std::vector<T> juntar_bytes(MPI_Comm comm, const std::vector<T>& locais) {
+    static_assert(std::is_trivially_copyable<T>::value, "juntar_bytes envia os elementos como bytes");
+
+    int rank = 0, num_processos = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_processos);
+
+    int bytes_locais = (int)(locais.size() * sizeof(T));
+    std::vector<int> bytes(num_processos), deslocamentos(num_processos, 0);
+    MPI_Gather(&bytes_locais, 1, MPI_INT, bytes.data(), 1, MPI_INT, 0, comm);
+    for (int r = 1; r < num_processos; ++r) deslocamentos[r] = deslocamentos[r - 1] + bytes[r - 1];
+
+    std::vector<T> todos;
+    if (rank == 0) todos.resize((deslocamentos.back() + bytes.back()) / sizeof(T));
+    MPI_Gatherv(locais.data(), bytes_locais, MPI_BYTE, todos.data(), bytes.data(), deslocamentos.data(),
+                MPI_BYTE, 0, comm);
+    return todos;
+}
+
+#endif // COLETIVAS_HPP
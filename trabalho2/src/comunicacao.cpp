@@ -0,0 +1,371 @@
+#include "comunicacao.hpp"
+#include "config.hpp"
+#include <omp.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+void FormatoMigracao::empacotar(const Agente* agentes, int n, unsigned char* pacote) {
+    uint16_t* x = reinterpret_cast<uint16_t*>(pacote + n * BYTES_ENERGIA);
+
+    if constexpr (Config::ENERGIA_QUANTIZADA) {
+        // Ponto fixo com passo PASSO_QUANTIZACAO_ENERGIA (arredondado e saturado em 16 bits)
+        uint16_t* energia = reinterpret_cast<uint16_t*>(pacote);
+        #pragma omp simd
+        for (int i = 0; i < n; ++i) {
+            float q = agentes[i].get_energia() / Config::PASSO_QUANTIZACAO_ENERGIA + 0.5f;
+            q = q < 0.0f ? 0.0f : (q > 65535.0f ? 65535.0f : q);
+            energia[i] = static_cast<uint16_t>(q);
+            x[i] = static_cast<uint16_t>(agentes[i].get_posicao().x);
+        }
+    } else {
+        float* energia = reinterpret_cast<float*>(pacote);
+        #pragma omp simd
+        for (int i = 0; i < n; ++i) {
+            energia[i] = agentes[i].get_energia();
+            x[i] = static_cast<uint16_t>(agentes[i].get_posicao().x);
+        }
+    }
+}
+
+void FormatoMigracao::desempacotar(const unsigned char* pacote, int n, int linha_y, Agente* agentes) {
+    // Campos escritos um a um, sem um Agente temporário: com o temporário, o GCC 12 (-O1/-O2)
+    // classifica esta função como `const` na análise IPA e descarta a chamada inteira
+    const uint16_t* x = reinterpret_cast<const uint16_t*>(pacote + n * BYTES_ENERGIA);
+
+    if constexpr (Config::ENERGIA_QUANTIZADA) {
+        const uint16_t* energia = reinterpret_cast<const uint16_t*>(pacote);
+        #pragma omp simd
+        for (int i = 0; i < n; ++i) {
+            agentes[i].set_posicao(Posicao(x[i], linha_y));
+            agentes[i].set_energia(energia[i] * Config::PASSO_QUANTIZACAO_ENERGIA);
+        }
+    } else {
+        const float* energia = reinterpret_cast<const float*>(pacote);
+        #pragma omp simd
+        for (int i = 0; i < n; ++i) {
+            agentes[i].set_posicao(Posicao(x[i], linha_y));
+            agentes[i].set_energia(energia[i]);
+        }
+    }
+}
+
+void FormatoMigracao::empacotar_ids(const IdAgente* ids, int n, unsigned char* pacote) {
+    // A seção começa num deslocamento qualquer do pacote: cópia de bytes, sem acesso desalinhado
+    std::memcpy(pacote + n * (BYTES_ENERGIA + sizeof(uint16_t)), ids, n * sizeof(IdAgente));
+}
+
+void FormatoMigracao::desempacotar_ids(const unsigned char* pacote, int n, IdAgente* ids) {
+    std::memcpy(ids, pacote + n * (BYTES_ENERGIA + sizeof(uint16_t)), n * sizeof(IdAgente));
+}
+
+CanalMigracao::CanalMigracao(MPI_Comm comm, int rank, int size, int linha_sup, int linha_inf, bool usar_thread)
+    : comm(comm), linha_chegada{linha_sup, linha_inf}, lotes_em_uso(0), pico_lotes(0),
+      proxima_recepcao{0, 0},
+      fim_producao(false), fim_enviado(true), fim_recebido{true, true}, enviados_ciclo(0),
+      usar_thread(usar_thread), ciclo_ativo(false), ciclo_concluido(false), encerrar(false) {
+
+    vizinho[static_cast<int>(Direcao::CIMA)]  = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    vizinho[static_cast<int>(Direcao::BAIXO)] = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+
+    // Cada thread OpenMP pode segurar um lote parcial por sentido; o pool precisa comportar
+    // todos eles e ainda sobrar buffers para circular, senão as threads se bloqueariam mutuamente.
+    limite_lotes = std::max(Config::LOTES_POOL_MIGRACAO, 2 * omp_get_max_threads() + 2);
+
+    // Recepções persistentes pré-postadas: os lotes podem chegar a qualquer momento do laço
+    for (int d = 0; d < 2; ++d) {
+        if (vizinho[d] == MPI_PROC_NULL) continue;
+        recepcoes[d].resize(Config::RECEPCOES_POR_VIZINHO);
+        for (Recepcao& r : recepcoes[d]) {
+            int bytes = (int)FormatoMigracao::tamanho_pacote(Config::TAMANHO_LOTE_MIGRACAO);
+            r.pacote.resize(bytes);
+            MPI_Recv_init(r.pacote.data(), bytes, MPI_BYTE, vizinho[d], TAG_LOTE, comm, &r.req);
+            MPI_Start(&r.req);
+        }
+    }
+
+    // A thread fica adormecida na variável de condição entre os ciclos (não compete por CPU)
+    if (usar_thread) {
+        thread_progresso = std::thread(&CanalMigracao::laco_progresso, this);
+    }
+}
+
+CanalMigracao::~CanalMigracao() {
+    if (usar_thread) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_estado);
+            encerrar = true;
+        }
+        cv_estado.notify_all();
+        thread_progresso.join();
+    }
+
+    // As recepções que sobraram postadas após o último marcador não vão casar com nada
+    for (int d = 0; d < 2; ++d) {
+        for (Recepcao& r : recepcoes[d]) {
+            MPI_Cancel(&r.req);
+            MPI_Wait(&r.req, MPI_STATUS_IGNORE);
+            MPI_Request_free(&r.req);
+        }
+    }
+}
+
+void CanalMigracao::iniciar_ciclo() {
+    recebidos.clear();
+    ids_recebidos.clear();
+    fim_producao.store(false);
+    fim_enviado = false;
+    fim_recebido[0] = !tem_vizinho(Direcao::CIMA);
+    fim_recebido[1] = !tem_vizinho(Direcao::BAIXO);
+    enviados_ciclo.store(0);
+
+    if (usar_thread) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_estado);
+            ciclo_concluido = false;
+            ciclo_ativo = true;
+        }
+        cv_estado.notify_all();
+    }
+}
+
+CanalMigracao::LoteEmprestado CanalMigracao::adquirir_lote() {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_pool);
+
+            // O pool é criado sob demanda até o limite (ou sem limite se ninguém devolve buffers)
+            if (lotes_livres.empty() && (!usar_thread || (int)pool_envio.size() < limite_lotes)) {
+                pool_envio.emplace_back();
+                pool_envio.back().agentes.resize(Config::TAMANHO_LOTE_MIGRACAO);
+                if (Config::IDS_AGENTES) pool_envio.back().ids.resize(Config::TAMANHO_LOTE_MIGRACAO);
+                pool_envio.back().pacote.resize(FormatoMigracao::tamanho_pacote(Config::TAMANHO_LOTE_MIGRACAO));
+                lotes_livres.push_back((int)pool_envio.size() - 1);
+            }
+
+            if (!lotes_livres.empty()) {
+                int indice = lotes_livres.back();
+                lotes_livres.pop_back();
+                pico_lotes = std::max(pico_lotes, ++lotes_em_uso);
+                return LoteEmprestado{indice, pool_envio[indice].agentes.data(), pool_envio[indice].ids.data(),
+                                      pool_envio[indice].pacote.data()};
+            }
+        }
+
+        // Pool esgotado: a thread de comunicação libera buffers à medida que os envios concluem
+        std::this_thread::yield();
+    }
+}
+
+void CanalMigracao::entregar_lote(Direcao d, const LoteEmprestado& lote, int quantidade) {
+    enviados_ciclo.fetch_add(quantidade);
+
+    // A codificação roda na thread OpenMP que produziu o lote, em paralelo com as demais
+    FormatoMigracao::empacotar(lote.agentes, quantidade, lote.pacote);
+    if (Config::IDS_AGENTES) FormatoMigracao::empacotar_ids(lote.ids, quantidade, lote.pacote);
+    int bytes = (int)FormatoMigracao::tamanho_pacote(quantidade);
+
+    std::lock_guard<std::mutex> lock(mutex_pool);
+    fila.push_back(EnvioPronto{d, lote.indice, lote.pacote, bytes});
+}
+
+void CanalMigracao::devolver_lote(int lote) {
+    std::lock_guard<std::mutex> lock(mutex_pool);
+    lotes_livres.push_back(lote);
+    --lotes_em_uso;
+}
+
+bool CanalMigracao::ciclo_completo() const {
+    return fim_enviado && fim_recebido[0] && fim_recebido[1] && reqs_envio.empty();
+}
+
+bool CanalMigracao::progredir() {
+    bool atividade = false;
+
+    // Lido ANTES de esvaziar a fila: se a produção já terminou, nenhum lote novo pode aparecer
+    // depois da troca abaixo, e o marcador de fim pode ser enviado com segurança neste passo.
+    bool producao_encerrada = fim_producao.load(std::memory_order_acquire);
+
+    // 1. Posta os envios não-bloqueantes dos lotes prontos
+    {
+        std::lock_guard<std::mutex> lock(mutex_pool);
+        prontos.swap(fila);
+    }
+    for (const EnvioPronto& envio : prontos) {
+        reqs_envio.push_back(MPI_REQUEST_NULL);
+        lotes_envio.push_back(envio.lote);
+        MPI_Isend(envio.pacote, envio.bytes, MPI_BYTE, vizinho[static_cast<int>(envio.direcao)],
+                  TAG_LOTE, comm, &reqs_envio.back());
+        atividade = true;
+    }
+    prontos.clear();
+
+    // 2. Marcador de fim (mensagem vazia) para cada vizinho existente
+    if (producao_encerrada && !fim_enviado) {
+        for (int d = 0; d < 2; ++d) {
+            if (vizinho[d] == MPI_PROC_NULL) continue;
+            reqs_envio.push_back(MPI_REQUEST_NULL);
+            lotes_envio.push_back(-1);
+            MPI_Isend(nullptr, 0, MPI_BYTE, vizinho[d], TAG_LOTE, comm, &reqs_envio.back());
+        }
+        fim_enviado = true;
+        atividade = true;
+    }
+
+    // 3. Consome as recepções concluídas na ordem de postagem e as reposta
+    for (int d = 0; d < 2; ++d) {
+        while (!fim_recebido[d]) {
+            Recepcao& r = recepcoes[d][proxima_recepcao[d]];
+            int chegou = 0;
+            MPI_Status status;
+            MPI_Test(&r.req, &chegou, &status);
+            if (!chegou) break;
+
+            int bytes = 0;
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            int quantidade = FormatoMigracao::quantidade_no_pacote(bytes);
+
+            size_t inicio = recebidos.size();
+            recebidos.resize(inicio + quantidade);
+            FormatoMigracao::desempacotar(r.pacote.data(), quantidade, linha_chegada[d], recebidos.data() + inicio);
+            if (Config::IDS_AGENTES) {
+                ids_recebidos.resize(inicio + quantidade);
+                FormatoMigracao::desempacotar_ids(r.pacote.data(), quantidade, ids_recebidos.data() + inicio);
+            }
+
+            MPI_Start(&r.req);
+            proxima_recepcao[d] = (proxima_recepcao[d] + 1) % (int)recepcoes[d].size();
+
+            if (quantidade == 0) fim_recebido[d] = true;
+            atividade = true;
+        }
+    }
+
+    // 4. Devolve ao pool os buffers dos envios já concluídos
+    for (size_t i = 0; i < reqs_envio.size();) {
+        int concluido = 0;
+        MPI_Test(&reqs_envio[i], &concluido, MPI_STATUS_IGNORE);
+        if (concluido) {
+            if (lotes_envio[i] >= 0) devolver_lote(lotes_envio[i]);
+            reqs_envio[i] = reqs_envio.back();
+            reqs_envio.pop_back();
+            lotes_envio[i] = lotes_envio.back();
+            lotes_envio.pop_back();
+            atividade = true;
+        } else {
+            ++i;
+        }
+    }
+
+    return atividade;
+}
+
+void CanalMigracao::laco_progresso() {
+    std::unique_lock<std::mutex> lock(mutex_estado);
+    while (true) {
+        cv_estado.wait(lock, [this] { return ciclo_ativo || encerrar; });
+        if (encerrar) return;
+        lock.unlock();
+
+        // Polling com recuo: cede a CPU às threads OpenMP quando não há nada a progredir
+        int passos_ociosos = 0;
+        while (!ciclo_completo()) {
+            if (progredir()) {
+                passos_ociosos = 0;
+            } else if (++passos_ociosos < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+            }
+        }
+
+        lock.lock();
+        ciclo_ativo = false;
+        ciclo_concluido = true;
+        cv_estado.notify_all();
+    }
+}
+
+void CanalMigracao::finalizar_ciclo(VetorAgentes& destino, VetorIds& ids_destino) {
+    fim_producao.store(true, std::memory_order_release);
+
+    if (usar_thread) {
+        std::unique_lock<std::mutex> lock(mutex_estado);
+        cv_estado.wait(lock, [this] { return ciclo_concluido; });
+    } else {
+        while (!ciclo_completo()) {
+            progredir();
+        }
+    }
+
+    destino.insert(destino.end(), recebidos.begin(), recebidos.end());
+    ids_destino.insert(ids_destino.end(), ids_recebidos.begin(), ids_recebidos.end());
+    recebidos.clear();
+    ids_recebidos.clear();
+}
+
+void BufferMigracao::adicionar(const Agente& a, IdAgente id) {
+    if (!canal.tem_vizinho(direcao)) return;
+
+    if (lote.indice < 0) {
+        lote = canal.adquirir_lote();
+    }
+    if (Config::IDS_AGENTES) lote.ids[quantidade] = id;
+    lote.agentes[quantidade++] = a;
+
+    if (quantidade == Config::TAMANHO_LOTE_MIGRACAO) {
+        descarregar();
+    }
+}
+
+JanelaTerritorio::JanelaTerritorio(MPI_Comm comm, int rank, int size, int floats_locais)
+    : memoria(nullptr), vizinho{nullptr, nullptr} {
+
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &comm_no);
+
+    // Segmentos não contíguos: cada rank pode ter sua faixa alocada (e tocada) no seu próprio nó NUMA
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+    MPI_Win_allocate_shared((MPI_Aint)floats_locais * sizeof(float), sizeof(float), info, comm_no,
+                            &memoria, &janela);
+    MPI_Info_free(&info);
+
+    // Época de acesso passivo permanente: a coerência é feita com MPI_Win_sync + barreira
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, janela);
+
+    // Traduz os vizinhos da decomposição (ranks de `comm`) para ranks do comunicador do nó
+    MPI_Group grupo, grupo_no;
+    MPI_Comm_group(comm, &grupo);
+    MPI_Comm_group(comm_no, &grupo_no);
+
+    int vizinhos[2] = {rank > 0 ? rank - 1 : MPI_PROC_NULL, rank < size - 1 ? rank + 1 : MPI_PROC_NULL};
+    for (int d = 0; d < 2; ++d) {
+        if (vizinhos[d] == MPI_PROC_NULL) continue;
+
+        int rank_no = MPI_UNDEFINED;
+        MPI_Group_translate_ranks(grupo, 1, &vizinhos[d], grupo_no, &rank_no);
+        if (rank_no == MPI_UNDEFINED) continue; // Vizinho em outro nó: halo por mensagem
+
+        MPI_Aint tamanho;
+        int unidade;
+        void* base = nullptr;
+        MPI_Win_shared_query(janela, rank_no, &tamanho, &unidade, &base);
+        vizinho[d] = static_cast<float*>(base);
+    }
+
+    MPI_Group_free(&grupo);
+    MPI_Group_free(&grupo_no);
+}
+
+JanelaTerritorio::~JanelaTerritorio() {
+    MPI_Win_unlock_all(janela);
+    MPI_Win_free(&janela);
+    MPI_Comm_free(&comm_no);
+}
+
+void JanelaTerritorio::sincronizar() {
+    MPI_Win_sync(janela);
+    MPI_Barrier(comm_no);
+    MPI_Win_sync(janela);
+}
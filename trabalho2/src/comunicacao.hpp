@@ -0,0 +1,265 @@
+#ifndef COMUNICACAO_HPP
+#define COMUNICACAO_HPP
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mpi.h>
+#include "agente.hpp"
+#include "identidade.hpp"
+#include "config.hpp"
+
+// Sentido da migração na decomposição 1D em faixas horizontais
+enum class Direcao {
+    CIMA = 0,  // para o rank - 1
+    BAIXO = 1  // para o rank + 1
+};
+
+// Formato compacto dos agentes migrantes na rede.
+//
+// Um agente só migra ao cruzar a fronteira da faixa, andando no máximo uma célula: ao chegar ele
+// está sempre na linha de borda do rank receptor (primeira linha se veio de cima, última se veio
+// de baixo). O y é portanto implícito (delta 0 em relação à linha de fronteira) e não trafega.
+// O x cabe em 16 bits para larguras realistas. Cada mensagem é um pacote SoA sem padding:
+//
+//     [energia: float (ou uint16 quantizado) x n][x: uint16 x n][id: uint64 x n, com IDS_AGENTES]
+//
+// São 6 bytes por agente (4 com ENERGIA_QUANTIZADA; mais 8 do id) contra os 12 do struct Agente
+// cru, e o formato não depende mais do layout/padding do struct. Os kernels são laços simples sobre
+// arrays separados, vetorizáveis com `omp simd`.
+namespace FormatoMigracao {
+    constexpr int LARGURA_MAXIMA = 65536; // x é codificado em uint16
+    constexpr size_t BYTES_ENERGIA = Config::ENERGIA_QUANTIZADA ? sizeof(uint16_t) : sizeof(float);
+    constexpr size_t BYTES_ID = Config::IDS_AGENTES ? sizeof(IdAgente) : 0;
+    constexpr size_t BYTES_POR_AGENTE = BYTES_ENERGIA + sizeof(uint16_t) + BYTES_ID;
+
+    inline size_t tamanho_pacote(int quantidade) { return quantidade * BYTES_POR_AGENTE; }
+    inline int quantidade_no_pacote(size_t bytes) { return (int)(bytes / BYTES_POR_AGENTE); }
+
+    // Codifica `n` agentes no pacote (que deve ter tamanho_pacote(n) bytes)
+    void empacotar(const Agente* agentes, int n, unsigned char* pacote);
+
+    // Decodifica `n` agentes do pacote, posicionando-os na linha global `linha_y`
+    void desempacotar(const unsigned char* pacote, int n, int linha_y, Agente* agentes);
+
+    // Seção dos ids (só com IDS_AGENTES), no fim do pacote de `n` agentes
+    void empacotar_ids(const IdAgente* ids, int n, unsigned char* pacote);
+    void desempacotar_ids(const unsigned char* pacote, int n, IdAgente* ids);
+}
+
+// Canal de migração de agentes entre ranks vizinhos com envio em lotes (streaming).
+//
+// As threads OpenMP preenchem lotes de tamanho fixo (TAMANHO_LOTE_MIGRACAO) tirados de um pool
+// limitado de buffers (LOTES_POOL_MIGRACAO) e os entregam assim que enchem, ainda durante o laço
+// de agentes. Uma thread de comunicação dedicada (opcional) posta os envios não-bloqueantes e
+// devolve cada buffer ao pool quando o envio conclui; se o pool esgotar, a thread OpenMP espera
+// um buffer ser liberado. Assim o pico de memória de envio fica limitado mesmo em migrações em
+// massa (troca de estação).
+//
+// Os agentes trafegam no formato compacto de FormatoMigracao: cada lote do pool tem a área de
+// preparo (Agente) preenchida pelas threads e o pacote codificado que de fato vai para o MPI.
+//
+// Na recepção, cada vizinho tem RECEPCOES_POR_VIZINHO recepções persistentes pré-postadas
+// (MPI_Recv_init) com buffers de um lote. Elas são consumidas na ordem em que foram postadas
+// (a mesma ordem de casamento do MPI), copiadas para a área de integração e repostadas.
+// Os agentes recebidos só entram na lista local no fim do ciclo.
+//
+// Protocolo por ciclo: cada rank envia N >= 0 lotes não vazios para cada vizinho e, ao final,
+// uma mensagem vazia como marcador de fim. Como mensagens MPI entre o mesmo par (mesma tag e
+// comunicador) não se ultrapassam, o marcador sempre chega depois de todos os lotes. Recepções
+// que continuam postadas após o marcador simplesmente recebem os primeiros lotes do próximo ciclo.
+//
+// Sem suporte a threads no MPI (nível < MPI_THREAD_SERIALIZED) ou com a thread desabilitada,
+// os lotes ficam na fila e quem progride o canal é a própria thread principal em finalizar_ciclo.
+// Nesse caso ninguém libera buffers durante o laço e o pool cresce sob demanda (sem limite).
+//
+// Contrato de chamadas MPI com a thread de comunicação (o que permite usar MPI_THREAD_SERIALIZED):
+//  - de iniciar_ciclo até o retorno de finalizar_ciclo, só a thread de comunicação chama o MPI
+//    (MPI_Isend, MPI_Test, MPI_Get_count e MPI_Start do canal). As threads OpenMP, inclusive a
+//    principal, não fazem nenhuma chamada MPI nessa janela: entregam lotes por adquirir_lote e
+//    entregar_lote (só mutex) e medem tempo com omp_get_wtime, não com MPI_Wtime;
+//  - fora dessa janela a thread de comunicação fica parada na variável de condição, e só a thread
+//    principal chama o MPI (halos, reduções, o próprio construtor e destrutor do canal).
+// A passagem entre as duas fases é feita sob mutex_estado, que ordena as chamadas das duas threads.
+class CanalMigracao {
+private:
+    static constexpr int TAG_LOTE = 10;
+
+    struct EnvioPronto {
+        Direcao direcao;
+        int lote;
+        const unsigned char* pacote; // Capturado na entrega: o deque do pool não pode ser indexado fora do mutex
+        int bytes;
+    };
+
+    struct Recepcao {
+        std::vector<unsigned char> pacote;
+        MPI_Request req;
+    };
+
+    struct Lote {
+        std::vector<Agente> agentes;        // Área de preparo preenchida pelas threads OpenMP
+        std::vector<IdAgente> ids;          // Ids dos agentes do preparo (só com IDS_AGENTES)
+        std::vector<unsigned char> pacote;  // Codificação compacta enviada ao vizinho
+    };
+
+    MPI_Comm comm;
+    int vizinho[2];      // rank de cima e de baixo (MPI_PROC_NULL se não existir)
+    int linha_chegada[2]; // Linha global onde chegam os agentes vindos de cada vizinho
+
+    // Pool de buffers de envio. std::deque não move os elementos ao crescer, então os ponteiros
+    // entregues às threads continuam válidos. Índices livres e fila protegidos por mutex_pool.
+    std::mutex mutex_pool;
+    std::deque<Lote> pool_envio;
+    std::vector<int> lotes_livres;
+    std::vector<EnvioPronto> fila;
+    std::vector<EnvioPronto> prontos; // Troca com a fila a cada passo de progresso (sem realocar)
+    int limite_lotes;  // Tamanho máximo do pool quando há thread de progresso
+    int lotes_em_uso;
+    int pico_lotes;    // Maior número de buffers em uso simultâneo (relatório de memória)
+
+    // Envios em andamento (apenas quem progride o canal mexe aqui)
+    std::vector<MPI_Request> reqs_envio;
+    std::vector<int> lotes_envio; // Lote do pool de cada envio (-1 para o marcador de fim)
+
+    // Recepções persistentes por vizinho, em anel na ordem de postagem
+    std::vector<Recepcao> recepcoes[2];
+    int proxima_recepcao[2];
+
+    // Estado do ciclo corrente (manipulado por quem progride o canal)
+    std::vector<Agente> recebidos;
+    std::vector<IdAgente> ids_recebidos;
+    std::atomic<bool> fim_producao;
+    bool fim_enviado;
+    bool fim_recebido[2];
+    std::atomic<int> enviados_ciclo;
+
+    // Thread de progresso e sua sincronização com a thread principal
+    bool usar_thread;
+    std::thread thread_progresso;
+    std::mutex mutex_estado;
+    std::condition_variable cv_estado;
+    bool ciclo_ativo;
+    bool ciclo_concluido;
+    bool encerrar;
+
+    void laco_progresso();
+    bool progredir();        // Um passo de progresso; retorna true se houve atividade
+    bool ciclo_completo() const;
+    void devolver_lote(int lote);
+
+public:
+    // Lote do pool emprestado a uma thread OpenMP
+    struct LoteEmprestado {
+        int indice;
+        Agente* agentes;
+        IdAgente* ids;
+        unsigned char* pacote;
+    };
+
+    // `linha_sup`/`linha_inf` são as linhas globais de borda da faixa local (onde os migrantes chegam).
+    // `usar_thread` só deve ser true se o MPI foi inicializado com nível >= MPI_THREAD_SERIALIZED
+    // (e o chamador respeita o contrato de chamadas MPI descrito acima)
+    CanalMigracao(MPI_Comm comm, int rank, int size, int linha_sup, int linha_inf, bool usar_thread);
+    ~CanalMigracao();
+
+    CanalMigracao(const CanalMigracao&) = delete;
+    CanalMigracao& operator=(const CanalMigracao&) = delete;
+
+    bool tem_thread_progresso() const { return usar_thread; }
+    bool tem_vizinho(Direcao d) const { return vizinho[static_cast<int>(d)] != MPI_PROC_NULL; }
+
+    // Abre o ciclo de migração. Deve ser chamado pela thread principal antes do laço de agentes;
+    // a partir daqui nenhuma thread além da de comunicação pode chamar o MPI até finalizar_ciclo
+    // retornar.
+    void iniciar_ciclo();
+
+    // Pega um buffer livre do pool (com capacidade TAMANHO_LOTE_MIGRACAO). Thread-safe; espera
+    // a thread de comunicação liberar um buffer se o pool estiver esgotado.
+    LoteEmprestado adquirir_lote();
+
+    // Codifica os `quantidade` primeiros agentes do lote (na thread chamadora, fora do mutex)
+    // e o entrega para envio ao vizinho `d` (thread-safe)
+    void entregar_lote(Direcao d, const LoteEmprestado& lote, int quantidade);
+
+    // Sinaliza que não haverá mais lotes, espera o canal concluir e anexa os agentes recebidos
+    // (e, com IDS_AGENTES, os ids deles em `ids_destino`)
+    void finalizar_ciclo(VetorAgentes& destino, VetorIds& ids_destino);
+
+    // Número de agentes enviados no ciclo corrente (métrica de migração)
+    int get_enviados_ciclo() const { return enviados_ciclo.load(); }
+
+    // Maior número de buffers do pool em uso simultâneo desde a criação do canal
+    int get_pico_lotes() {
+        std::lock_guard<std::mutex> lock(mutex_pool);
+        return pico_lotes;
+    }
+};
+
+// Grade do território alocada numa janela MPI-3 de memória compartilhada do nó.
+//
+// Os ranks do mesmo nó (MPI_Comm_split_type com MPI_COMM_TYPE_SHARED) alocam suas faixas com
+// MPI_Win_allocate_shared (com o anel fantasma do Territorio), e um rank cujo vizinho está no mesmo
+// nó lê a linha de borda dele direto da janela (MPI_Win_shared_query), copiando-a para a sua linha
+// fantasma: sem mensagem, só uma cópia local de uma linha por ciclo.
+// Só os vizinhos em outros nós continuam trocando halos por mensagens.
+//
+// Sincronização: o vizinho precisa ter concluído atualizar_recursos antes da nossa leitura
+// (sincronizar(), chamada no lugar da troca de halos: MPI_Win_sync + barreira do nó). Como o
+// recurso tem dois planos, a atualização seguinte do vizinho escreve o outro plano, não o que
+// estamos copiando; ela só volta a este plano depois de mais uma barreira do nó.
+class JanelaTerritorio {
+private:
+    MPI_Comm comm_no;
+    MPI_Win janela;
+    float* memoria;
+    float* vizinho[2]; // Planos do vizinho no mesmo nó (nullptr se não houver ou estiver em outro nó)
+
+public:
+    JanelaTerritorio(MPI_Comm comm, int rank, int size, int floats_locais);
+    ~JanelaTerritorio();
+
+    JanelaTerritorio(const JanelaTerritorio&) = delete;
+    JanelaTerritorio& operator=(const JanelaTerritorio&) = delete;
+
+    float* memoria_local() { return memoria; }
+    float* memoria_vizinho(Direcao d) { return vizinho[static_cast<int>(d)]; }
+    bool compartilha_com(Direcao d) const { return vizinho[static_cast<int>(d)] != nullptr; }
+
+    // Torna visíveis as escritas do ciclo anterior de todos os ranks do nó
+    void sincronizar();
+};
+
+// Acumulador de migrantes de uma thread OpenMP para um sentido: preenche um lote do pool e o
+// entrega ao canal assim que ele enche. `descarregar` entrega o lote parcial no fim do laço.
+class BufferMigracao {
+private:
+    CanalMigracao& canal;
+    Direcao direcao;
+    CanalMigracao::LoteEmprestado lote;
+    int quantidade;
+
+public:
+    BufferMigracao(CanalMigracao& canal, Direcao direcao)
+        : canal(canal), direcao(direcao), lote{-1, nullptr, nullptr, nullptr}, quantidade(0) {}
+
+    ~BufferMigracao() { descarregar(); }
+
+    // `id` só é usado com IDS_AGENTES
+    void adicionar(const Agente& a, IdAgente id = 0);
+
+    void descarregar() {
+        if (lote.indice >= 0) {
+            canal.entregar_lote(direcao, lote, quantidade);
+            lote = CanalMigracao::LoteEmprestado{-1, nullptr, nullptr, nullptr};
+            quantidade = 0;
+        }
+    }
+};
+
+#endif // COMUNICACAO_HPP
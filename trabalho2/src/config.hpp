@@ -10,6 +10,7 @@ namespace Config {
     constexpr int SEED = 42;
     constexpr int TOTAL_CICLOS = 40;
     constexpr int TAMANHO_CICLO_SAZONAL = 4;
+    constexpr bool METRICAS_ASSINCRONAS = true;   // Formatação e escrita das métricas numa thread à parte do rank 0
     
     // Configurações dos Agentes
     constexpr int N_AGENTS = 100000;
@@ -18,12 +19,47 @@ namespace Config {
     constexpr float EFICIENCIA_REABASTECIMENTO = 0.4f;
     constexpr float THRESHOLD_REPRODUCAO = 25.0f;      // Energia mínima para o agente se reproduzir
     constexpr float FATOR_ENERGIA_REPRODUCAO = 0.4f;   // Fração da energia do pai transferida ao filho na reprodução
+    constexpr bool PERCEPCAO_ESTENDIDA = false;        // Agentes com pouco recurso na célula seguem a pirâmide de recursos (piramide.hpp)
+    constexpr int NIVEIS_PIRAMIDE = 4;                 // Ladrilhos de 2x2 até 2^N x 2^N células (alcance de ~2^N células)
+    constexpr float LIMIAR_PERCEPCAO_ESTENDIDA = RECURSO_REQUERIDO_AGENTE; // Recurso da célula abaixo do qual o agente olha a pirâmide
+
+    // Configurações da População Inicial (perfil de densidade; ver densidade.hpp)
+    constexpr int PESO_INICIAL_ALDEIA = 40;            // Pesos do perfil "tipos": aglomera a população nas aldeias
+    constexpr int PESO_INICIAL_PESCA = 4;
+    constexpr int PESO_INICIAL_COLETA = 1;
+    constexpr int PESO_INICIAL_ROCADO = 2;
+    constexpr float ESCALA_MAPA_DENSIDADE = 1000.0f;   // Valores de um mapa de densidade viram pesos inteiros (valor * escala)
     
     // Configurações de Carga de Trabalho e Custo de Energia
     constexpr int MAX_CUSTO = 10000;               // Limite máximo de iterações da carga sintética (evita loops excessivos)
     constexpr float CUSTO_METABOLICO = 3.0f;       // Gasto fixo de energia do agente por ciclo (custo base de sobrevivência)
     constexpr float TAXA_CUSTO_ESFORCO = 0.002f;   // Fator de conversão do esforço computacional em gasto de energia (custo = iterações * taxa)
     constexpr float FATOR_CARGA_TRABALHO = 100.0f; // Multiplicador que escala o recurso local em número de iterações da carga sintética
+    constexpr bool CARGA_SINTETICA = true;         // Executa o laço da carga sintética (o gasto de energia é cobrado de qualquer forma)
+    
+    // Configurações do Kernel de Agentes
+    constexpr bool KERNEL_AGENTES_EM_LOTE = true;  // Processa os agentes em lotes SIMD (false: caminho escalar de referência)
+    constexpr int LARGURA_LOTE_AGENTES = 16;       // Agentes por passo do kernel em lote (múltiplo da largura SIMD)
+    constexpr bool VERIFICAR_KERNEL_LOTE = false;  // Confere no início da execução que o lote reproduz o escalar bit a bit
+    constexpr bool ESTRATEGIA_AGENTES_ADAPTATIVA = true; // Escolhe a cada ciclo serial/estática/dinâmica/lote (ver estrategia_agentes.hpp)
+    constexpr float LIMIAR_SERIAL_FORK_JOIN = 4.0f;      // Laço serial enquanto o trabalho estimado couber nesse número de fork/joins
+    constexpr int AGENTES_LOTE_POR_THREAD = 4 * LARGURA_LOTE_AGENTES; // Abaixo disso por thread, caminho por agente
+    constexpr float LIMIAR_DESEQUILIBRIO = 1.3f;         // Thread mais lenta / média acima disso: escalonamento dinâmico
+    constexpr int AGENTES_POR_PEDACO_DINAMICO = 256;     // Agentes por pedaço no escalonamento dinâmico (múltiplo do lote)
+    constexpr int CICLOS_REAVALIACAO_DINAMICA = 8;       // Ciclos dinâmicos entre duas medidas do desequilíbrio por faixa
+    constexpr bool IDS_AGENTES = true;                   // Id global de 64 bits por agente num array frio paralelo (identidade.hpp)
+    constexpr int IDS_POR_BLOCO = 1024;                  // Ids de nascimento que cada thread reserva de uma vez na faixa do rank
+    
+    // Configurações de Comunicação (MPI)
+    constexpr bool THREAD_COMUNICACAO = true;     // Thread dedicada que progride a migração durante o laço de agentes
+    constexpr int TAMANHO_LOTE_MIGRACAO = 256;     // Agentes por lote enviado ao vizinho (streaming da migração)
+    constexpr int LOTES_POOL_MIGRACAO = 16;        // Buffers de envio no pool (limite de memória da migração)
+    constexpr int RECEPCOES_POR_VIZINHO = 4;       // Recepções persistentes pré-postadas por vizinho
+    constexpr bool HALO_MEMORIA_COMPARTILHADA = true; // Halos lidos da memória de vizinhos no mesmo nó (janela MPI-3)
+    constexpr bool ENERGIA_QUANTIZADA = false;     // Energia dos migrantes em ponto fixo de 16 bits (com perda)
+    constexpr float PASSO_QUANTIZACAO_ENERGIA = 1.0f / 1024.0f; // Resolução da energia quantizada (máx. ~64)
+    constexpr int PROFUNDIDADE_BLOCO_TEMPORAL = 1; // Ciclos entre sincronizações com os vizinhos (> 1: halos de 3k linhas)
+    constexpr bool UM_PROCESSO_SO_OPENMP = true;   // Com 1 processo: grade inteira num Territorio, sem halos nem canal de migração
     
     // Configurações de Território (Recursos Máximos)
     constexpr float RECURSO_MAX_ALDEIA = 25.0f;
@@ -0,0 +1,121 @@
+#include "densidade.hpp"
+#include "identidade.hpp"
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+    // splitmix64: mistura de 64 bits sem estado, suficiente como gerador baseado em contador
+    uint64_t misturar(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // floor(a * b / c) sem estouro (a, b, c < 2^63)
+    long long mult_div(long long a, long long b, long long c) {
+        return (long long)((unsigned __int128)a * (unsigned __int128)b / (unsigned __int128)c);
+    }
+}
+
+bool PerfilDensidade::carregar(const std::string& descricao, int largura, int altura,
+                               PerfilDensidade& perfil, std::string& erro) {
+    perfil = PerfilDensidade();
+    perfil.nome = descricao;
+    perfil.largura_grid = largura;
+    perfil.altura_grid = altura;
+
+    if (descricao == "uniforme") {
+        perfil.tipo = Tipo::UNIFORME;
+        return true;
+    }
+    if (descricao == "tipos") {
+        perfil.tipo = Tipo::POR_TIPO;
+        return true;
+    }
+
+    std::ifstream arquivo(descricao);
+    if (!arquivo) {
+        erro = "não consegui abrir o mapa de densidade " + descricao;
+        return false;
+    }
+    int l = 0, a = 0;
+    if (!(arquivo >> l >> a) || l <= 0 || a <= 0) {
+        erro = "cabeçalho inválido no mapa de densidade " + descricao + " (esperado: largura altura)";
+        return false;
+    }
+
+    perfil.tipo = Tipo::MAPA;
+    perfil.largura_mapa = l;
+    perfil.altura_mapa = a;
+    perfil.pesos_mapa.resize((size_t)l * a);
+    for (uint32_t& peso : perfil.pesos_mapa) {
+        double valor = 0.0;
+        if (!(arquivo >> valor) || !(valor >= 0.0) || valor * Config::ESCALA_MAPA_DENSIDADE > 4.0e9) {
+            erro = "valor ausente, negativo ou grande demais no mapa de densidade " + descricao;
+            return false;
+        }
+        peso = (uint32_t)std::llround(valor * Config::ESCALA_MAPA_DENSIDADE);
+    }
+    return true;
+}
+
+VetorAgentes inicializar_agentes(MPI_Comm comm, const PerfilDensidade& perfil, long long total_agentes,
+                                 int largura, int altura, Posicao offset, uint64_t semente, VetorIds* ids) {
+    // Prefixos inclusivos dos pesos dentro de cada linha (cada thread soma as suas linhas)
+    std::vector<long long> acumulado((size_t)largura * altura);
+    std::vector<long long> inicio_linha(altura + 1, 0);
+    #pragma omp parallel for schedule(static)
+    for (int y = 0; y < altura; ++y) {
+        long long* linha = acumulado.data() + (size_t)y * largura;
+        long long soma = 0;
+        for (int x = 0; x < largura; ++x) {
+            soma += perfil.peso(offset.x + x, offset.y + y);
+            linha[x] = soma;
+        }
+        inicio_linha[y + 1] = soma;
+    }
+    for (int y = 0; y < altura; ++y) inicio_linha[y + 1] += inicio_linha[y];
+
+    // Fatia [peso_antes, peso_antes + peso_local) do total de pesos, na ordem dos ranks
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    long long peso_local = inicio_linha[altura];
+    long long peso_antes = 0;
+    long long peso_total = 0;
+    MPI_Exscan(&peso_local, &peso_antes, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0) peso_antes = 0; // O resultado do MPI_Exscan no rank 0 é indefinido
+    MPI_Allreduce(&peso_local, &peso_total, 1, MPI_LONG_LONG, MPI_SUM, comm);
+
+    VetorAgentes agentes;
+    if (ids) ids->clear();
+    if (peso_total == 0 || peso_local == 0) return agentes;
+
+    // Índices globais dos agentes deste rank: a divisão inteira dá a mesma fronteira aos dois
+    // ranks vizinhos, então a soma das quotas é exatamente total_agentes
+    long long k_ini = mult_div(total_agentes, peso_antes, peso_total);
+    long long k_fim = mult_div(total_agentes, peso_antes + peso_local, peso_total);
+    agentes.resize(k_fim - k_ini);
+    if (ids) ids->resize(k_fim - k_ini);
+
+    // O vetor sem inicializar é tocado primeiro pela thread que escreve cada parte
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < k_fim - k_ini; ++i) {
+        // Ponto uniforme em [0, peso_local) (multiplicação de 64 x 64 bits, sem viés de módulo)
+        uint64_t sorteio = misturar(semente ^ misturar((uint64_t)(k_ini + i)));
+        long long alvo = (long long)(((unsigned __int128)sorteio * (uint64_t)peso_local) >> 64);
+
+        // Linha: a última cujo início não passa do alvo (linhas de peso zero nunca são escolhidas)
+        int y = (int)(std::upper_bound(inicio_linha.begin(), inicio_linha.end(), alvo) - inicio_linha.begin()) - 1;
+        // Coluna: a primeira cujo prefixo inclusivo passa do alvo
+        const long long* linha = acumulado.data() + (size_t)y * largura;
+        int x = (int)(std::upper_bound(linha, linha + largura, alvo - inicio_linha[y]) - linha);
+
+        agentes[i].set_posicao(Posicao(offset.x + x, offset.y + y));
+        agentes[i].set_energia(Config::ENERGIA_INICIAL_AGENTE);
+        if (ids) (*ids)[i] = IdsAgentes::inicial(k_ini + i);
+    }
+    return agentes;
+}
@@ -0,0 +1,73 @@
+#ifndef DENSIDADE_HPP
+#define DENSIDADE_HPP
+
+#include <mpi.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "agente.hpp"
+#include "territorio.hpp"
+
+// Perfil de densidade da população inicial: um peso inteiro (>= 0) por célula global, e cada
+// agente nasce numa célula com probabilidade proporcional ao peso dela. Pesos inteiros deixam as
+// somas de prefixo exatas, iguais em qualquer número de processos e threads.
+//
+//     uniforme          peso 1 em todas as células
+//     tipos             peso por tipo de célula (PESO_INICIAL_* de config.hpp; ex.: aglomerado nas aldeias)
+//     <arquivo>         mapa de densidade em texto: "L A" e depois A linhas de L valores >= 0,
+//                       reamostrado para o grid pelo vizinho mais próximo
+class PerfilDensidade {
+public:
+    enum class Tipo { UNIFORME, POR_TIPO, MAPA };
+
+private:
+    Tipo tipo;
+    std::string nome;
+    int largura_grid, altura_grid;
+    int largura_mapa, altura_mapa;
+    std::vector<uint32_t> pesos_mapa; // Valores do mapa já quantizados (ESCALA_MAPA_DENSIDADE)
+
+    static constexpr uint32_t PESOS_POR_TIPO[TabelasTerritorio::NUM_TIPOS] = {
+        Config::PESO_INICIAL_ALDEIA, Config::PESO_INICIAL_PESCA, Config::PESO_INICIAL_COLETA,
+        Config::PESO_INICIAL_ROCADO, 0
+    };
+
+public:
+    PerfilDensidade() : tipo(Tipo::UNIFORME), nome("uniforme"), largura_grid(0), altura_grid(0),
+                        largura_mapa(0), altura_mapa(0) {}
+
+    // Interpreta `descricao` ("uniforme", "tipos" ou caminho de um mapa) para um grid global
+    // largura x altura. Retorna false e descreve o problema em `erro` se o mapa não puder ser lido.
+    static bool carregar(const std::string& descricao, int largura, int altura,
+                         PerfilDensidade& perfil, std::string& erro);
+
+    const std::string& get_nome() const { return nome; }
+
+    uint32_t peso(int gx, int gy) const {
+        switch (tipo) {
+            case Tipo::POR_TIPO:
+                return PESOS_POR_TIPO[static_cast<int>(TabelasTerritorio::tipo(gx, gy))];
+            case Tipo::MAPA: {
+                int mx = (int)((long long)gx * largura_mapa / largura_grid);
+                int my = (int)((long long)gy * altura_mapa / altura_grid);
+                return pesos_mapa[(size_t)my * largura_mapa + mx];
+            }
+            default:
+                return 1;
+        }
+    }
+};
+
+// Cria a população inicial da faixa [offset.y, offset.y + altura) do grid em paralelo.
+//
+// Cada rank soma os pesos das suas células em prefixos por linha (linhas divididas entre as
+// threads) e descobre pela soma de prefixo entre os ranks (MPI_Exscan) qual fatia do total de
+// pesos lhe cabe; os `total_agentes` índices globais são repartidos entre os ranks na proporção
+// exata dessas fatias. O agente de índice global k sorteia sua célula com um gerador baseado em
+// contador (semente, k) e busca binária nos prefixos: cada thread cria uma parte do vetor sem
+// estado compartilhado, então o resultado não depende do número de threads.
+// Com `ids`, preenche o id de cada agente (o índice global k, IdsAgentes::inicial) na mesma ordem.
+VetorAgentes inicializar_agentes(MPI_Comm comm, const PerfilDensidade& perfil, long long total_agentes,
+                                 int largura, int altura, Posicao offset, uint64_t semente, VetorIds* ids = nullptr);
+
+#endif // DENSIDADE_HPP
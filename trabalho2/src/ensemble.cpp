@@ -0,0 +1,140 @@
+#include "ensemble.hpp"
+#include "coletivas.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+bool aplicar_parametro(Cenario& cenario, const std::string& chave, const std::string& valor) {
+    char* fim = nullptr;
+    if (chave == "semente") {
+        unsigned long long semente = std::strtoull(valor.c_str(), &fim, 10);
+        if (*fim != '\0' || valor.empty()) return false;
+        cenario.semente = semente;
+        return true;
+    }
+
+    float* destino = nullptr;
+    if (chave == "threshold_reproducao") destino = &cenario.regras.threshold_reproducao;
+    else if (chave == "taxa_regeneracao_cheia") destino = &cenario.regras.taxa_regeneracao_cheia;
+    else if (chave == "taxa_regeneracao_seca") destino = &cenario.regras.taxa_regeneracao_seca;
+    else if (chave == "fator_carga_trabalho") destino = &cenario.regras.fator_carga_trabalho;
+    if (destino == nullptr) return false;
+
+    float numero = std::strtof(valor.c_str(), &fim);
+    if (*fim != '\0' || valor.empty() || !(numero >= 0.0f)) return false;
+    *destino = numero;
+    return true;
+}
+
+bool carregar_cenarios(const std::string& caminho, std::vector<Cenario>& cenarios, std::string& erro) {
+    std::ifstream arquivo(caminho);
+    if (!arquivo) {
+        erro = "não consegui abrir o arquivo de cenários " + caminho;
+        return false;
+    }
+
+    cenarios.clear();
+    std::string linha;
+    int numero_linha = 0;
+    while (std::getline(arquivo, linha)) {
+        ++numero_linha;
+        std::istringstream campos(linha);
+        std::string nome;
+        if (!(campos >> nome) || nome[0] == '#') continue;
+
+        Cenario cenario;
+        cenario.nome = nome;
+        std::string par;
+        while (campos >> par) {
+            size_t igual = par.find('=');
+            if (igual == std::string::npos || !aplicar_parametro(cenario, par.substr(0, igual), par.substr(igual + 1))) {
+                erro = caminho + ":" + std::to_string(numero_linha) + ": parâmetro inválido " + par;
+                return false;
+            }
+        }
+        cenarios.push_back(cenario);
+    }
+    if (cenarios.empty()) {
+        erro = "nenhum cenário em " + caminho;
+        return false;
+    }
+    return true;
+}
+
+Ensemble::Ensemble(MPI_Comm mundo, int num_cenarios) : tempos{} {
+    int rank_mundo = 0, size_mundo = 1;
+    MPI_Comm_rank(mundo, &rank_mundo);
+    MPI_Comm_size(mundo, &size_mundo);
+
+    // Blocos consecutivos: ranks do mesmo cenário tendem a ficar no mesmo nó (halos na janela compartilhada)
+    processos_por_cenario = size_mundo / num_cenarios;
+    indice = rank_mundo / processos_por_cenario;
+    MPI_Comm_split(mundo, indice, rank_mundo, &comm_cenario);
+
+    int rank_cenario = 0;
+    MPI_Comm_rank(comm_cenario, &rank_cenario);
+    MPI_Comm_split(mundo, rank_cenario == 0 ? 0 : MPI_UNDEFINED, rank_mundo, &comm_lideres);
+}
+
+Ensemble::~Ensemble() {
+    if (comm_lideres != MPI_COMM_NULL) MPI_Comm_free(&comm_lideres);
+    MPI_Comm_free(&comm_cenario);
+}
+
+void Ensemble::registrar(const RegistroMetricas& registro) {
+    registros.push_back(registro);
+    registros.back().cenario = indice;
+}
+
+void Ensemble::registrar_tempos(const double* tempos_cenario) {
+    std::copy(tempos_cenario, tempos_cenario + NUM_TEMPOS, tempos);
+}
+
+void Ensemble::imprimir_fluxo_combinado(MPI_Comm mundo, const std::vector<Cenario>& cenarios, SaidaMetricas* saida) {
+    // Os demais ranks só esperam: a impressão é o fim da execução
+    if (comm_lideres == MPI_COMM_NULL) {
+        MPI_Barrier(mundo);
+        return;
+    }
+
+    int rank_lider = 0, num_lideres = 1;
+    MPI_Comm_rank(comm_lideres, &rank_lider);
+    MPI_Comm_size(comm_lideres, &num_lideres);
+
+    // Registros de todos os líderes (cada um com a sua quantidade)
+    std::vector<RegistroMetricas> todos = juntar_bytes(comm_lideres, registros);
+
+    std::vector<double> tempos_todos(rank_lider == 0 ? (size_t)NUM_TEMPOS * num_lideres : 0);
+    MPI_Gather(tempos, NUM_TEMPOS, MPI_DOUBLE, tempos_todos.data(), NUM_TEMPOS, MPI_DOUBLE, 0, comm_lideres);
+
+    if (rank_lider == 0) {
+        // Estável: as linhas por rank continuam logo depois dos totais do seu ciclo
+        std::stable_sort(todos.begin(), todos.end(), [](const RegistroMetricas& a, const RegistroMetricas& b) {
+            return a.ciclo != b.ciclo ? a.ciclo < b.ciclo : a.cenario < b.cenario;
+        });
+        for (const RegistroMetricas& r : todos) saida->registrar(r);
+        saida->esvaziar();
+
+        // Tempos por cenário e, nas chaves usuais, o do cenário mais lento em cada fase
+        std::cout << "cenario";
+        for (int i = 0; i < NUM_TEMPOS; ++i) std::cout << "," << CHAVES_TEMPOS[i] << "_SECONDS";
+        std::cout << std::endl << std::fixed << std::setprecision(6);
+        double maximos[NUM_TEMPOS] = {};
+        for (int l = 0; l < num_lideres; ++l) {
+            std::cout << campo_csv(cenarios[l].nome);
+            for (int i = 0; i < NUM_TEMPOS; ++i) {
+                double t = tempos_todos[(size_t)l * NUM_TEMPOS + i];
+                std::cout << "," << t;
+                maximos[i] = std::max(maximos[i], t);
+            }
+            std::cout << std::endl;
+        }
+        for (int i = 0; i < NUM_TEMPOS; ++i) {
+            std::cout << CHAVES_TEMPOS[i] << "_SECONDS=" << maximos[i] << std::endl;
+        }
+    }
+    MPI_Barrier(mundo);
+}
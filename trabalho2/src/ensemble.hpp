@@ -0,0 +1,72 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <mpi.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "regras.hpp"
+#include "metricas.hpp"
+#include "saida_metricas.hpp"
+
+// Um cenário de um estudo de parâmetros: nome, semente da população inicial e regras
+struct Cenario {
+    std::string nome = "padrao";
+    uint64_t semente = Config::SEED;
+    RegrasCenario regras;
+};
+
+// Lê o arquivo de cenários: uma linha por cenário, com o nome e pares chave=valor sobre os
+// padrões de config.hpp. Linhas vazias e as iniciadas por '#' são ignoradas.
+//
+//     base
+//     limiar30   threshold_reproducao=30
+//     seca_dura  taxa_regeneracao_seca=0.01  semente=7
+//
+// Chaves: semente, threshold_reproducao, taxa_regeneracao_cheia, taxa_regeneracao_seca,
+// fator_carga_trabalho. Retorna false e descreve o problema em `erro`.
+bool carregar_cenarios(const std::string& caminho, std::vector<Cenario>& cenarios, std::string& erro);
+
+// Aplica um par chave=valor (as chaves acima) ao cenário; false se a chave ou o valor forem inválidos
+bool aplicar_parametro(Cenario& cenario, const std::string& chave, const std::string& valor);
+
+// Vários cenários independentes num só job MPI.
+//
+// MPI_COMM_WORLD é dividido (MPI_Comm_split) em blocos consecutivos de size / num_cenarios ranks,
+// um por cenário. Cada cenário roda a simulação inteira no seu comunicador, com as suas regras e
+// a sua semente, sem sincronizar com os outros: cenários mais leves terminam antes. O rank 0 de
+// cada cenário (o líder) usa o Ensemble como destino das métricas: guarda os registros dos ciclos
+// e os tempos em vez de imprimi-los, e no fim o rank 0 do mundo junta tudo e repassa um único
+// fluxo de métricas, por ciclo e cenário, ao destino escolhido (--metricas).
+class Ensemble : public SaidaMetricas {
+private:
+    int indice;
+    int processos_por_cenario;
+    MPI_Comm comm_cenario;
+    MPI_Comm comm_lideres; // Só os líderes; MPI_COMM_NULL nos demais ranks
+    std::vector<RegistroMetricas> registros;
+    double tempos[NUM_TEMPOS];
+
+public:
+    // Coletiva em `mundo`; o tamanho de `mundo` precisa ser múltiplo de `num_cenarios`
+    Ensemble(MPI_Comm mundo, int num_cenarios);
+    ~Ensemble();
+
+    Ensemble(const Ensemble&) = delete;
+    Ensemble& operator=(const Ensemble&) = delete;
+
+    int get_indice() const { return indice; }
+    int get_processos_por_cenario() const { return processos_por_cenario; }
+    MPI_Comm get_comm() const { return comm_cenario; }
+
+    // Chamadas só pelo líder do cenário
+    void registrar(const RegistroMetricas& registro) override;
+    void registrar_tempos(const double* tempos_cenario);
+
+    // Coletiva em `mundo`: junta registros e tempos dos líderes no rank 0 do mundo, passa o fluxo
+    // combinado para `saida` (só o rank 0 do mundo precisa de uma) e imprime os tempos por cenário
+    // e o maior tempo de cada fase (CHAVE_SECONDS=valor)
+    void imprimir_fluxo_combinado(MPI_Comm mundo, const std::vector<Cenario>& cenarios, SaidaMetricas* saida);
+};
+
+#endif // ENSEMBLE_HPP
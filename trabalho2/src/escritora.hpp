@@ -0,0 +1,100 @@
+#ifndef ESCRITORA_HPP
+#define ESCRITORA_HPP
+
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <ios>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Thread escritora para tirar a escrita do caminho do ciclo: quem produz só enfileira os itens e
+// segue; a escritora acorda, troca a fila inteira por um vetor vazio e entrega o lote à função de
+// escrita fora do mutex. Usada pelas métricas assíncronas (um item por registro) e pelo log de
+// linhagem (um item por ciclo).
+template <typename Item>
+class EscritoraAssincrona {
+public:
+    // Chamada só pela thread escritora, com um lote de itens na ordem em que foram enfileirados
+    using Escrever = std::function<void(std::vector<Item>& lote)>;
+
+private:
+    Escrever escrever;
+    std::mutex mutex;
+    std::condition_variable tem_itens;
+    std::condition_variable lote_escrito;
+    std::vector<Item> fila;
+    long long enfileirados;
+    long long escritos;
+    bool encerrar;
+    std::thread escritora;
+
+    void escrever_lotes() {
+        std::vector<Item> lote;
+        std::unique_lock<std::mutex> trava(mutex);
+        while (true) {
+            tem_itens.wait(trava, [this] { return encerrar || !fila.empty(); });
+            if (fila.empty()) return;
+
+            lote.swap(fila);
+            trava.unlock();
+            escrever(lote);
+            trava.lock();
+
+            escritos += (long long)lote.size();
+            lote.clear();
+            lote_escrito.notify_all();
+        }
+    }
+
+public:
+    explicit EscritoraAssincrona(Escrever escrever)
+        : escrever(std::move(escrever)), enfileirados(0), escritos(0), encerrar(false),
+          escritora(&EscritoraAssincrona::escrever_lotes, this) {}
+
+    ~EscritoraAssincrona() { fechar(); }
+
+    EscritoraAssincrona(const EscritoraAssincrona&) = delete;
+    EscritoraAssincrona& operator=(const EscritoraAssincrona&) = delete;
+
+    void enfileirar(Item item) {
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            fila.push_back(std::move(item));
+            ++enfileirados;
+        }
+        tem_itens.notify_one();
+    }
+
+    // Espera a escritora entregar tudo o que já foi enfileirado
+    void esperar() {
+        std::unique_lock<std::mutex> trava(mutex);
+        lote_escrito.wait(trava, [this] { return escritos == enfileirados; });
+    }
+
+    // Escreve o que falta e encerra a thread. Chamadas seguintes não fazem nada.
+    void fechar() {
+        if (!escritora.joinable()) return;
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            encerrar = true;
+        }
+        tem_itens.notify_one();
+        escritora.join();
+    }
+};
+
+// Abre `arquivo` com `buffer` (de `bytes`) no lugar do buffer padrão do ofstream, que precisa ser
+// instalado antes da abertura
+inline bool abrir_com_buffer(std::ofstream& arquivo, std::vector<char>& buffer, size_t bytes, const std::string& caminho,
+                             std::ios::openmode modo = std::ios::out) {
+    buffer.resize(bytes);
+    arquivo.rdbuf()->pubsetbuf(buffer.data(), (std::streamsize)buffer.size());
+    arquivo.open(caminho, modo);
+    return arquivo.is_open();
+}
+
+#endif // ESCRITORA_HPP
@@ -0,0 +1,85 @@
+#include "estrategia_agentes.hpp"
+#include <omp.h>
+#include <algorithm>
+
+const char* nome_estrategia(EstrategiaAgentes estrategia) {
+    switch (estrategia) {
+        case EstrategiaAgentes::SERIAL: return "serial";
+        case EstrategiaAgentes::ESTATICA: return "estatica";
+        case EstrategiaAgentes::DINAMICA: return "dinamica";
+        default: return "lote";
+    }
+}
+
+SeletorEstrategia::SeletorEstrategia()
+    : sobrecarga_fork_join(0.0), custo_agente(0.0), desequilibrio(1.0), ciclos_em_dinamica(0),
+      tempo_thread(omp_get_max_threads(), 0.0) {
+    if (!Config::ESTRATEGIA_AGENTES_ADAPTATIVA) return;
+
+    // Regiões vazias com uma barreira, como a do laço de agentes; a primeira (criação das
+    // threads) fica de fora da medida
+    constexpr int REPETICOES = 32;
+    #pragma omp parallel
+    {
+        #pragma omp barrier
+    }
+    double inicio = omp_get_wtime();
+    for (int i = 0; i < REPETICOES; ++i) {
+        #pragma omp parallel
+        {
+            #pragma omp barrier
+        }
+    }
+    sobrecarga_fork_join = (omp_get_wtime() - inicio) / REPETICOES;
+}
+
+EstrategiaAgentes SeletorEstrategia::escolher(int num_agentes) {
+    if (!Config::ESTRATEGIA_AGENTES_ADAPTATIVA) {
+        return Config::KERNEL_AGENTES_EM_LOTE ? EstrategiaAgentes::LOTE : EstrategiaAgentes::ESTATICA;
+    }
+
+    int nt = (int)tempo_thread.size();
+    if (num_agentes == 0) return EstrategiaAgentes::SERIAL;
+
+    // Trabalho do laço inteiro numa thread contra o custo de abrir a região. Sem medida ainda
+    // (primeiro ciclo), segue para as estratégias paralelas, que medem o custo por agente.
+    double trabalho = num_agentes * custo_agente;
+    if (nt > 1 && custo_agente > 0.0 && trabalho < Config::LIMIAR_SERIAL_FORK_JOIN * sobrecarga_fork_join) {
+        return EstrategiaAgentes::SERIAL;
+    }
+
+    if (num_agentes / nt < Config::AGENTES_LOTE_POR_THREAD) {
+        return nt == 1 ? EstrategiaAgentes::SERIAL : EstrategiaAgentes::ESTATICA;
+    }
+
+    if (nt > 1 && desequilibrio > Config::LIMIAR_DESEQUILIBRIO) {
+        // Volta a medir o desequilíbrio por faixa de tempos em tempos
+        if (ciclos_em_dinamica < Config::CICLOS_REAVALIACAO_DINAMICA) return EstrategiaAgentes::DINAMICA;
+        ciclos_em_dinamica = 0;
+    }
+    return EstrategiaAgentes::LOTE;
+}
+
+int SeletorEstrategia::equipe(EstrategiaAgentes estrategia) const {
+    return estrategia == EstrategiaAgentes::SERIAL ? 1 : (int)tempo_thread.size();
+}
+
+void SeletorEstrategia::concluir(EstrategiaAgentes estrategia, int num_agentes, int equipe) {
+    if (num_agentes == 0) return;
+
+    double soma = 0.0, maximo = 0.0;
+    for (int t = 0; t < equipe; ++t) {
+        soma += tempo_thread[t];
+        maximo = std::max(maximo, tempo_thread[t]);
+    }
+
+    // Média móvel: a população e os recursos mudam devagar entre ciclos, mas a medida é ruidosa
+    double custo = soma / num_agentes;
+    custo_agente = custo_agente > 0.0 ? 0.5 * custo_agente + 0.5 * custo : custo;
+
+    if (estrategia == EstrategiaAgentes::DINAMICA) {
+        ciclos_em_dinamica++;
+    } else if (equipe > 1 && soma > 0.0) {
+        desequilibrio = maximo / (soma / equipe);
+    }
+}
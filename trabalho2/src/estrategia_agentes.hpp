@@ -0,0 +1,62 @@
+#ifndef ESTRATEGIA_AGENTES_HPP
+#define ESTRATEGIA_AGENTES_HPP
+
+#include <vector>
+#include "config.hpp"
+
+// Como o laço de agentes de um ciclo é executado:
+//
+//  - SERIAL: só a thread principal (região paralela inativa), agente a agente. Para populações
+//    tão pequenas que o fork/join custaria mais que o próprio laço.
+//  - ESTATICA: todas as threads, um bloco contíguo (a faixa) por thread, agente a agente. Poucos
+//    agentes por thread para encher lotes SIMD.
+//  - DINAMICA: todas as threads, pedaços de AGENTES_POR_PEDACO_DINAMICO agentes distribuídos
+//    dinamicamente, cada pedaço pelo kernel em lote. Para populações grandes com carga desigual
+//    entre as faixas (a carga sintética depende do recurso local).
+//  - LOTE: todas as threads, uma faixa por thread, pelo kernel em lote (padrão).
+//
+// Os quatro dão os mesmos eventos para cada agente (o kernel em lote reproduz o escalar). No
+// escalonamento dinâmico, agentes da mesma célula podem cair em threads diferentes, então a ordem
+// das somas atômicas de consumo (e os últimos dígitos dos totais de recurso) pode variar.
+enum class EstrategiaAgentes { SERIAL, ESTATICA, DINAMICA, LOTE };
+
+constexpr int NUM_ESTRATEGIAS_AGENTES = 4;
+const char* nome_estrategia(EstrategiaAgentes estrategia);
+
+// Escolhe a estratégia de cada ciclo pela população atual e pelo que foi medido nos anteriores:
+// o custo do fork/join (medido uma vez, com regiões vazias), o custo por agente (tempo de thread
+// somado / agentes, média móvel) e o desequilíbrio entre as threads (mais lenta / média) nas
+// estratégias por faixa. Em DINAMICA o desequilíbrio por faixa não é observável, então a cada
+// CICLOS_REAVALIACAO_DINAMICA ciclos um ciclo por faixa o mede de novo.
+//
+// Uso por ciclo: escolher(n) antes do laço, registrar_thread(t, s) por thread dentro da região
+// e concluir(...) depois dela.
+class SeletorEstrategia {
+private:
+    double sobrecarga_fork_join; // s por região paralela com todas as threads
+    double custo_agente;         // s de thread por agente (0: ainda não medido)
+    double desequilibrio;        // Thread mais lenta / média, no último ciclo por faixa
+    int ciclos_em_dinamica;
+    std::vector<double> tempo_thread;
+
+public:
+    SeletorEstrategia();
+
+    EstrategiaAgentes escolher(int num_agentes);
+
+    // Threads da região paralela para a estratégia (1 em SERIAL)
+    int equipe(EstrategiaAgentes estrategia) const;
+
+    // Se a estratégia usa o kernel em lote (as por agente usam o escalar)
+    static bool em_lote(EstrategiaAgentes estrategia) {
+        return Config::KERNEL_AGENTES_EM_LOTE &&
+               (estrategia == EstrategiaAgentes::DINAMICA || estrategia == EstrategiaAgentes::LOTE);
+    }
+
+    // Tempo de trabalho da thread t no laço do ciclo (chamada por cada thread da região)
+    void registrar_thread(int t, double segundos) { tempo_thread[t] = segundos; }
+
+    void concluir(EstrategiaAgentes estrategia, int num_agentes, int equipe);
+};
+
+#endif // ESTRATEGIA_AGENTES_HPP
@@ -0,0 +1,123 @@
+#ifndef IDENTIDADE_HPP
+#define IDENTIDADE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "agente.hpp"
+#include "config.hpp"
+
+// Identidade dos agentes (IDS_AGENTES): um id global de 64 bits por agente, guardado num array
+// frio paralelo à lista de agentes (mesmo índice), fora do struct Agente que o laço quente lê.
+// Os ids acompanham os agentes no laço, na migração e no reagrupamento por faixa.
+//
+// São únicos sem comunicação: os bits acima de BITS_SEQUENCIA dizem quem criou o agente (0 para
+// a população inicial, r + 1 para os nascidos no rank r) e os de baixo são uma sequência dentro
+// dessa origem (o índice global na população inicial; a ordem de reserva no rank).
+// IdAgente e VetorIds ficam em agente.hpp, ao lado de VetorAgentes.
+
+namespace IdsAgentes {
+    constexpr int BITS_SEQUENCIA = 40;
+
+    inline IdAgente inicial(long long indice_global) { return (IdAgente)indice_global; }
+    inline IdAgente primeiro_do_rank(int rank) { return (IdAgente)(rank + 1) << BITS_SEQUENCIA; }
+
+    // Rank onde o agente nasceu (-1: população inicial)
+    inline int origem(IdAgente id) { return (int)(id >> BITS_SEQUENCIA) - 1; }
+}
+
+// Faixa de ids de nascimento de um rank. Cada thread reserva IDS_POR_BLOCO ids de uma vez (um
+// fetch_add a cada IDS_POR_BLOCO nascimentos) e numera dentro do bloco sem sincronizar: os ids
+// são únicos, mas a numeração dos nascidos depende da ordem das reservas entre as threads.
+class GeradorIds {
+private:
+    std::atomic<IdAgente> proximo;
+
+public:
+    explicit GeradorIds(int rank) : proximo(IdsAgentes::primeiro_do_rank(rank)) {}
+
+    IdAgente reservar_bloco() { return proximo.fetch_add(Config::IDS_POR_BLOCO, std::memory_order_relaxed); }
+};
+
+// Bloco de ids de uma thread (sobrevive entre ciclos: as sobras do bloco não se perdem)
+struct BlocoIds {
+    IdAgente proximo = 0;
+    IdAgente fim = 0;
+
+    IdAgente novo(GeradorIds& gerador) {
+        if (proximo == fim) {
+            proximo = gerador.reservar_bloco();
+            fim = proximo + Config::IDS_POR_BLOCO;
+        }
+        return proximo++;
+    }
+};
+
+// Ids dos agentes locais de um rank (na ordem da lista de agentes) e a sua faixa de ids de
+// nascimento. vetor() é nullptr sem IDS_AGENTES, para as funções em que os ids são opcionais.
+struct IdsLocais {
+    VetorIds ids;
+    GeradorIds gerador;
+
+    explicit IdsLocais(int rank) : gerador(rank) {}
+
+    VetorIds* vetor() { return Config::IDS_AGENTES ? &ids : nullptr; }
+};
+
+// Evento do log de linhagem (linhagem.hpp). Migrações são registradas por quem envia.
+enum class TipoEventoLinhagem : uint8_t { NASCIMENTO = 0, MORTE = 1, MIGRACAO_CIMA = 2, MIGRACAO_BAIXO = 3 };
+
+struct EventoLinhagem {
+    IdAgente id;    // Agente do evento (no nascimento, o filho)
+    IdAgente pai;   // Só no nascimento
+    TipoEventoLinhagem tipo;
+};
+
+// Ids da saída de uma thread no laço de agentes. Os kernels emitem, na ordem dos agentes de
+// origem, exatamente um de morte/migrante/local por agente e o nascimento logo depois do local do
+// pai: um cursor sobre os ids de origem basta para saber de quem é cada evento, sem que o kernel
+// conheça os ids.
+class IdsThread {
+private:
+    const IdAgente* origem;             // Ids dos agentes de origem (mesmo índice)
+    const IdAgente* cursor;             // Próximo agente de origem a emitir
+    IdAgente atual;                     // Último agente de origem emitido (o pai de um nascimento)
+    std::vector<IdAgente>& lista_local; // Paralela à lista local de agentes da thread
+    BlocoIds& bloco;
+    GeradorIds& gerador;
+    std::vector<EventoLinhagem>* eventos; // nullptr sem log de linhagem
+
+public:
+    IdsThread(const IdAgente* origem, std::vector<IdAgente>& lista_local, BlocoIds& bloco, GeradorIds& gerador,
+              std::vector<EventoLinhagem>* eventos)
+        : origem(origem), cursor(origem), atual(0), lista_local(lista_local), bloco(bloco), gerador(gerador), eventos(eventos) {}
+
+    // O kernel vai processar os agentes de origem a partir do índice `inicio`
+    void trecho(int inicio) { cursor = origem + inicio; }
+
+    void morte() {
+        atual = *cursor++;
+        if (eventos) eventos->push_back(EventoLinhagem{atual, 0, TipoEventoLinhagem::MORTE});
+    }
+
+    IdAgente migrante(bool para_cima) {
+        atual = *cursor++;
+        if (eventos) {
+            eventos->push_back(EventoLinhagem{atual, 0, para_cima ? TipoEventoLinhagem::MIGRACAO_CIMA : TipoEventoLinhagem::MIGRACAO_BAIXO});
+        }
+        return atual;
+    }
+
+    void local() {
+        atual = *cursor++;
+        lista_local.push_back(atual);
+    }
+
+    void nascimento() {
+        IdAgente filho = bloco.novo(gerador);
+        lista_local.push_back(filho);
+        if (eventos) eventos->push_back(EventoLinhagem{filho, atual, TipoEventoLinhagem::NASCIMENTO});
+    }
+};
+
+#endif // IDENTIDADE_HPP
@@ -0,0 +1,93 @@
+#include "kernel_agentes.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace {
+    // Saída que registra a sequência de eventos do kernel para comparação
+    struct SaidaRegistro {
+        struct Evento {
+            int tipo; // 0 = morte, 1 = migra para cima, 2 = migra para baixo, 3 = local, 4 = nascimento
+            Agente agente;
+        };
+        std::vector<Evento> eventos;
+
+        void morte() { eventos.push_back(Evento{0, Agente()}); }
+        void migrante(Direcao d, const Agente& a) { eventos.push_back(Evento{d == Direcao::CIMA ? 1 : 2, a}); }
+        void local(const Agente& a) { eventos.push_back(Evento{3, a}); }
+        void nascimento(const Agente& filho) { eventos.push_back(Evento{4, filho}); }
+    };
+
+    // Gerador congruencial simples (determinístico e independente de rand())
+    struct Gerador {
+        uint32_t estado;
+        uint32_t proximo() { estado = estado * 1664525u + 1013904223u; return estado >> 8; }
+        float uniforme(float maximo) { return maximo * (proximo() & 0xFFFF) / 65535.0f; }
+    };
+
+    // Recursos pseudoaleatórios (com empates frequentes) nas células próprias e nos dois halos
+    void preencher(Territorio& t, uint32_t semente) {
+        Gerador g{semente};
+        for (int y = -1; y <= t.get_altura(); ++y) {
+            for (int x = 0; x < t.get_largura(); ++x) {
+                *t.ptr_recurso(Posicao(x, y)) = (g.proximo() % 4 == 0) ? 10.0f : g.uniforme(25.0f);
+            }
+        }
+    }
+
+    bool iguais(const Agente& a, const Agente& b) {
+        return a.get_posicao() == b.get_posicao() && a.get_energia() == b.get_energia();
+    }
+}
+
+bool verificar_kernel_lote() {
+    // Subgrid no meio do grid global (halos dos dois lados), com largura que não é múltiplo do lote
+    const int largura = 53, altura = 37;
+    const Posicao offset(0, 41);
+    const int num_agentes = 20 * Config::LARGURA_LOTE_AGENTES + 7;
+
+    const Estacao estacoes[2] = {Estacao::SECA, Estacao::CHEIA};
+    for (Estacao estacao : estacoes) {
+        Territorio escalar(largura, altura, offset);
+        Territorio lote(largura, altura, offset);
+        escalar.inicializar(estacao);
+        lote.inicializar(estacao);
+        preencher(escalar, 7u);
+        preencher(lote, 7u);
+
+        // Com PERCEPCAO_ESTENDIDA, os dois caminhos consultam a mesma pirâmide (só as células
+        // próprias: os ladrilhos da fronteira ficam parciais, o que não importa para a comparação)
+        PiramideRecursos piramide(largura, 2 * offset.y + altura, offset.y, altura);
+        if (Config::PERCEPCAO_ESTENDIDA) {
+            piramide.atualizar(escalar, MPI_COMM_SELF, 0, 1);
+            escalar.usar_piramide(&piramide);
+            lote.usar_piramide(&piramide);
+        }
+
+        // Energias espalhadas em torno dos limiares de morte e de reprodução; posições em toda a
+        // faixa, inclusive as linhas de borda (migrantes)
+        Gerador g{42u};
+        std::vector<Agente> agentes;
+        for (int i = 0; i < num_agentes; ++i) {
+            Posicao p(g.proximo() % largura + offset.x, g.proximo() % altura + offset.y);
+            agentes.push_back(Agente(p, g.uniforme(40.0f)));
+        }
+
+        SaidaRegistro saida_escalar, saida_lote;
+        for (const Agente& a : agentes) processar_agente_escalar(a, escalar, saida_escalar);
+        processar_lote_agentes(agentes.data(), num_agentes, lote, saida_lote);
+
+        if (saida_escalar.eventos.size() != saida_lote.eventos.size()) return false;
+        for (size_t i = 0; i < saida_escalar.eventos.size(); ++i) {
+            const SaidaRegistro::Evento& e = saida_escalar.eventos[i];
+            const SaidaRegistro::Evento& l = saida_lote.eventos[i];
+            if (e.tipo != l.tipo || !iguais(e.agente, l.agente)) return false;
+        }
+
+        for (int y = 0; y < altura; ++y) {
+            for (int x = 0; x < largura; ++x) {
+                if (escalar.get_consumo(Posicao(x, y)) != lote.get_consumo(Posicao(x, y))) return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,234 @@
+#ifndef KERNEL_AGENTES_HPP
+#define KERNEL_AGENTES_HPP
+
+#include "agente.hpp"
+#include "territorio.hpp"
+#include "comunicacao.hpp"
+#include "config.hpp"
+#include "piramide.hpp"
+
+// Kernel do ciclo de um agente: carga sintética e gasto de energia, morte, decisão, migração ou
+// permanência, consumo e reprodução. Há duas implementações com resultado idêntico bit a bit:
+//
+//  - processar_agente_escalar: um agente por vez, pelos métodos de Agente (referência)
+//  - processar_lote_agentes: LARGURA_LOTE_AGENTES agentes por passo. O lote é copiado da lista
+//    (AoS) para arrays locais SoA e cada fase é um laço `omp simd` sobre as pistas: gather dos
+//    recursos, argmax da vizinhança, atualização de energia e máscaras de morte, migração e
+//    nascimento. A largura do vetor (SSE/AVX2/AVX-512) vem das flags de compilação.
+//    Só a carga sintética (opcional) e a emissão dos resultados, na ordem original dos agentes,
+//    são escalares.
+//
+// Os resultados saem por um objeto `Saida` com os métodos
+//     void morte();
+//     void migrante(Direcao d, const Agente& a);
+//     void local(const Agente& a);
+//     void nascimento(const Agente& filho);
+// chamados na mesma ordem pelos dois caminhos (inclusive o registro atômico do consumo na
+// célula, feito logo antes de `local`). VERIFICAR_KERNEL_LOTE confere a equivalência.
+//
+// A igualdade bit a bit exige que o compilador não contraia multiplicação + soma em FMA de forma
+// diferente nos dois caminhos: builds com -march que tenha FMA devem usar -ffp-contract=off.
+
+template <typename Saida>
+inline void processar_agente_escalar(const Agente& agente, Territorio& subgrid, Saida& saida) {
+    Agente a = agente;
+    Posicao offset = subgrid.get_offset();
+    Posicao atual = a.get_posicao();
+    float r = subgrid.get_recurso(Posicao(atual.x - offset.x, atual.y - offset.y));
+
+    // 1. Executa carga de trabalho e CONSOME energia
+    a.executar_carga(r);
+
+    // 2. Verifica se o agente ainda está vivo
+    if (a.get_energia() <= 0) {
+        saida.morte();
+        return;
+    }
+
+    // 3. Se vivo, decide o próximo passo
+    Posicao destino;
+    a.decidir(subgrid, destino);
+    a.set_posicao(destino);
+
+    // Lógica de Migração ou Permanência Local
+    int linha_destino = destino.y - offset.y;
+    if (linha_destino < 0) {
+        saida.migrante(Direcao::CIMA, a);
+    } else if (linha_destino >= subgrid.get_altura()) {
+        saida.migrante(Direcao::BAIXO, a);
+    } else {
+        a.consumir_recurso(subgrid);
+        saida.local(a);
+
+        // 4. Verifica se o agente se reproduz após consumir recurso
+        Agente filho;
+        if (a.reproduzir(subgrid, filho)) {
+            saida.nascimento(filho);
+        }
+    }
+}
+
+template <typename Saida>
+void processar_lote_agentes(const Agente* agentes, int n, Territorio& subgrid, Saida& saida) {
+    constexpr int B = Config::LARGURA_LOTE_AGENTES;
+    constexpr const int (&DX)[8] = TabelasTerritorio::VIZINHO_DX;
+    constexpr const int (&DY)[8] = TabelasTerritorio::VIZINHO_DY;
+    constexpr int PX = TabelasTerritorio::PERIODO_X;
+    constexpr int PY = TabelasTerritorio::PERIODO_Y;
+    constexpr float FANTASMA = Territorio::RECURSO_FANTASMA;
+
+    const int passo = subgrid.get_passo();
+    const int altura = subgrid.get_altura();
+    const Posicao offset = subgrid.get_offset();
+    const float* recurso = subgrid.ptr_recurso(Posicao(0, 0)); // Plano corrente: um float por célula
+    const int* mascaras = &TabelasTerritorio::MASCARA_VIZINHANCA[static_cast<int>(subgrid.get_estacao())][0][0];
+
+    // Passo de cada escolha do argmax: 0 = ficar na célula, i + 1 = vizinho i
+    constexpr int PASSO_X[9] = {0, DX[0], DX[1], DX[2], DX[3], DX[4], DX[5], DX[6], DX[7]};
+    constexpr int PASSO_Y[9] = {0, DY[0], DY[1], DY[2], DY[3], DY[4], DY[5], DY[6], DY[7]};
+
+    // Deslocamento de cada vizinho na grade com borda
+    int desloc[8];
+    for (int i = 0; i < 8; ++i) desloc[i] = DY[i] * passo + DX[i];
+
+    // Vizinhos das linhas de cima (bits 0-2) e de baixo (bits 5-7) na máscara de vizinhança
+    constexpr int BITS_LINHA_CIMA = 0x07;
+    constexpr int BITS_LINHA_BAIXO = 0xE0;
+
+    // Regras do cenário em locais: os stores em float dos laços não forçam releitura
+    const float fator_carga = Regras::atuais.fator_carga_trabalho;
+    const float limiar_reproducao = Regras::atuais.threshold_reproducao;
+    const PiramideRecursos* piramide = subgrid.get_piramide();
+
+    // Estado SoA do lote. Índices de célula relativos à célula local (0, 0); `acesso` é a
+    // máscara de vizinhos acessíveis da posição corrente
+    alignas(64) int gx[B], gy[B], indice[B], acesso[B], custo[B], escolhido[B];
+    alignas(64) int regiao[B], filho_x[B], filho_y[B], vivo[B], nasce[B];
+    alignas(64) float energia[B], energia_local[B], consumo[B], energia_filho[B], melhor[B];
+
+    for (int inicio = 0; inicio < n; inicio += B) {
+        const int m = (n - inicio < B) ? n - inicio : B;
+
+        // 1. AoS -> SoA. Pistas excedentes repetem a primeira (endereços válidos, resultado descartado)
+        for (int k = 0; k < B; ++k) {
+            const Agente& a = agentes[inicio + (k < m ? k : 0)];
+            gx[k] = a.get_posicao().x;
+            gy[k] = a.get_posicao().y;
+            energia[k] = a.get_energia();
+        }
+
+        // 2. Carga: custo pelo recurso da célula atual, gasto de energia e máscara de morte
+        #pragma omp simd
+        for (int k = 0; k < B; ++k) {
+            indice[k] = (gy[k] - offset.y) * passo + (gx[k] - offset.x);
+            acesso[k] = mascaras[(gy[k] % PY) * PX + gx[k] % PX];
+            float atual = recurso[indice[k]];
+            custo[k] = custo_carga(atual, fator_carga);
+            energia[k] -= gasto_energia(custo[k]);
+            vivo[k] = energia[k] > 0;
+            melhor[k] = atual;
+            escolhido[k] = 0;
+        }
+
+        if (Config::CARGA_SINTETICA) {
+            for (int k = 0; k < m; ++k) carga_sintetica(custo[k]);
+        }
+
+        // 3. Decisão: argmax (primeiro máximo) sobre a célula atual e os 8 vizinhos. Um laço SIMD
+        //    por vizinho; as leituras são incondicionais (o anel fantasma garante endereço válido)
+        for (int i = 0; i < 8; ++i) {
+            #pragma omp simd
+            for (int k = 0; k < B; ++k) {
+                float vizinho = recurso[indice[k] + desloc[i]];
+                float candidato = ((acesso[k] >> i) & 1) ? vizinho : FANTASMA;
+                bool melhora = candidato > melhor[k];
+                melhor[k] = melhora ? candidato : melhor[k];
+                escolhido[k] = melhora ? i + 1 : escolhido[k];
+            }
+        }
+
+        // Percepção estendida (como em Agente::decidir): pistas com pouco recurso na célula
+        // trocam o argmax pela direção da pirâmide, um a um (consulta com desvios por nível)
+        if (Config::PERCEPCAO_ESTENDIDA && piramide) {
+            for (int k = 0; k < m; ++k) {
+                if (recurso[indice[k]] >= Config::LIMIAR_PERCEPCAO_ESTENDIDA) continue;
+                int d = piramide->direcao(gx[k], gy[k]);
+                if (d >= 0 && ((acesso[k] >> d) & 1)) escolhido[k] = d + 1;
+            }
+        }
+
+        // Move para o destino. Região: 0 = local, 1 = migra para cima, 2 = migra para baixo.
+        // Migrantes ficam na célula de origem para os estênceis seguintes (resultado descartado):
+        // a vizinhança de uma linha fantasma sairia da grade com borda.
+        #pragma omp simd
+        for (int k = 0; k < B; ++k) {
+            int dx = PASSO_X[escolhido[k]];
+            int dy = PASSO_Y[escolhido[k]];
+            gx[k] += dx;
+            gy[k] += dy;
+            int linha = gy[k] - offset.y;
+            regiao[k] = (linha < 0) ? 1 : (linha >= altura ? 2 : 0);
+            indice[k] += (regiao[k] == 0) ? dy * passo + dx : 0;
+        }
+
+        // 4. Consumo na célula de destino (só vale para os locais vivos)
+        #pragma omp simd
+        for (int k = 0; k < B; ++k) {
+            float disponivel = recurso[indice[k]];
+            consumo[k] = (disponivel >= Config::RECURSO_REQUERIDO_AGENTE) ? Config::RECURSO_REQUERIDO_AGENTE : disponivel;
+            energia_local[k] = energia[k] + consumo[k] * Config::EFICIENCIA_REABASTECIMENTO;
+
+            // Vizinhos do destino: acessíveis e dentro das linhas próprias (o filho nunca nasce no halo)
+            int linha = gy[k] - offset.y;
+            int bits_linhas = 0xFF & ~(linha <= 0 ? BITS_LINHA_CIMA : 0) & ~(linha >= altura - 1 ? BITS_LINHA_BAIXO : 0);
+            acesso[k] = mascaras[(gy[k] % PY) * PX + gx[k] % PX] & bits_linhas;
+            melhor[k] = FANTASMA;
+            escolhido[k] = 0;
+        }
+
+        // 5. Reprodução: argmax sobre os vizinhos acessíveis dentro das linhas próprias
+        for (int i = 0; i < 8; ++i) {
+            #pragma omp simd
+            for (int k = 0; k < B; ++k) {
+                float vizinho = recurso[indice[k] + desloc[i]];
+                float candidato = ((acesso[k] >> i) & 1) ? vizinho : FANTASMA;
+                bool melhora = candidato > melhor[k];
+                melhor[k] = melhora ? candidato : melhor[k];
+                escolhido[k] = melhora ? i + 1 : escolhido[k];
+            }
+        }
+
+        #pragma omp simd
+        for (int k = 0; k < B; ++k) {
+            nasce[k] = (energia_local[k] > limiar_reproducao) & (escolhido[k] > 0);
+            energia_filho[k] = energia_local[k] * Config::FATOR_ENERGIA_REPRODUCAO;
+            filho_x[k] = gx[k] + PASSO_X[escolhido[k]];
+            filho_y[k] = gy[k] + PASSO_Y[escolhido[k]];
+        }
+
+        // 6. Emissão na ordem dos agentes (mesma sequência do caminho escalar)
+        for (int k = 0; k < m; ++k) {
+            if (!vivo[k]) {
+                saida.morte();
+                continue;
+            }
+            Posicao destino(gx[k], gy[k]);
+            if (regiao[k] != 0) {
+                saida.migrante(regiao[k] == 1 ? Direcao::CIMA : Direcao::BAIXO, Agente(destino, energia[k]));
+                continue;
+            }
+            subgrid.registrar_consumo(Posicao(destino.x - offset.x, destino.y - offset.y), consumo[k]);
+            saida.local(Agente(destino, energia_local[k]));
+            if (nasce[k]) {
+                saida.nascimento(Agente(Posicao(filho_x[k], filho_y[k]), energia_filho[k]));
+            }
+        }
+    }
+}
+
+// Confere, num território sintético com halos, que processar_lote_agentes reproduz exatamente
+// processar_agente_escalar nas duas estações (eventos, agentes e consumo por célula).
+// Retorna true se forem idênticos.
+bool verificar_kernel_lote();
+
+#endif // KERNEL_AGENTES_HPP
@@ -0,0 +1,101 @@
+#include "linhagem.hpp"
+#include <algorithm>
+
+namespace {
+    void escrever_varint(std::vector<unsigned char>& saida, uint64_t valor) {
+        while (valor >= 0x80) {
+            saida.push_back((unsigned char)(valor | 0x80));
+            valor >>= 7;
+        }
+        saida.push_back((unsigned char)valor);
+    }
+
+    // Inteiro com sinal em sem sinal com magnitude pequena: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    uint64_t zigue_zague(int64_t valor) { return ((uint64_t)valor << 1) ^ (uint64_t)(valor >> 63); }
+}
+
+LogLinhagem::LogLinhagem(const std::string& caminho, int rank)
+    : eventos_gravados(0), bytes_gravados(0), escritora([this](std::vector<Lote>& lotes) { gravar(lotes); }) {
+    if (!abrir_com_buffer(arquivo, buffer, 1 << 20, caminho + "." + std::to_string(rank), std::ios::binary)) return;
+
+    std::string cabecalho = "trabalho2-linhagem rank=" + std::to_string(rank) +
+                            " bits_sequencia=" + std::to_string(IdsAgentes::BITS_SEQUENCIA) + "\n";
+    arquivo.write(cabecalho.data(), (std::streamsize)cabecalho.size());
+    bytes_gravados = (long long)cabecalho.size();
+}
+
+LogLinhagem::~LogLinhagem() {
+    long long eventos = 0, bytes = 0;
+    fechar(eventos, bytes);
+}
+
+void LogLinhagem::fechar(long long& eventos, long long& bytes) {
+    escritora.fechar();
+    if (arquivo.is_open()) arquivo.close();
+    eventos = eventos_gravados;
+    bytes = bytes_gravados;
+}
+
+void LogLinhagem::registrar(int ciclo, std::vector<EventoLinhagem>& eventos) {
+    if (eventos.empty()) return;
+
+    std::vector<EventoLinhagem> vazio;
+    {
+        std::lock_guard<std::mutex> trava(mutex_livres);
+        if (!livres.empty()) {
+            vazio.swap(livres.back());
+            livres.pop_back();
+        }
+    }
+    Lote lote{ciclo, std::vector<EventoLinhagem>()};
+    lote.eventos.swap(eventos);
+    eventos.swap(vazio);
+    escritora.enfileirar(std::move(lote));
+}
+
+void LogLinhagem::gravar(std::vector<Lote>& lotes) {
+    for (Lote& lote : lotes) {
+        comprimir(lote);
+        arquivo.write(reinterpret_cast<const char*>(bloco.data()), (std::streamsize)bloco.size());
+        eventos_gravados += (long long)lote.eventos.size();
+        bytes_gravados += (long long)bloco.size();
+        lote.eventos.clear();
+    }
+
+    std::lock_guard<std::mutex> trava(mutex_livres);
+    for (Lote& lote : lotes) livres.push_back(std::move(lote.eventos));
+}
+
+void LogLinhagem::comprimir(Lote& lote) {
+    // Por tipo e, dentro do tipo, por id: os deltas ficam pequenos e positivos
+    std::vector<EventoLinhagem>& eventos = lote.eventos;
+    std::sort(eventos.begin(), eventos.end(), [](const EventoLinhagem& a, const EventoLinhagem& b) {
+        return a.tipo != b.tipo ? a.tipo < b.tipo : a.id < b.id;
+    });
+
+    uint64_t contagem[4] = {0, 0, 0, 0};
+    for (const EventoLinhagem& e : eventos) contagem[(int)e.tipo]++;
+
+    corpo.clear();
+    for (uint64_t c : contagem) escrever_varint(corpo, c);
+    IdAgente id_anterior = 0;
+    IdAgente pai_anterior = 0;
+    TipoEventoLinhagem tipo_anterior = TipoEventoLinhagem::NASCIMENTO;
+    for (const EventoLinhagem& e : eventos) {
+        if (e.tipo != tipo_anterior) {
+            id_anterior = 0;
+            tipo_anterior = e.tipo;
+        }
+        escrever_varint(corpo, e.id - id_anterior);
+        id_anterior = e.id;
+        if (e.tipo == TipoEventoLinhagem::NASCIMENTO) {
+            escrever_varint(corpo, zigue_zague((int64_t)(e.pai - pai_anterior)));
+            pai_anterior = e.pai;
+        }
+    }
+
+    bloco.clear();
+    escrever_varint(bloco, (uint64_t)lote.ciclo);
+    escrever_varint(bloco, corpo.size());
+    bloco.insert(bloco.end(), corpo.begin(), corpo.end());
+}
@@ -0,0 +1,67 @@
+#ifndef LINHAGEM_HPP
+#define LINHAGEM_HPP
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "escritora.hpp"
+#include "identidade.hpp"
+
+// Log de linhagem (--linhagem <arquivo>, exige IDS_AGENTES): nascimentos (filho e pai), mortes e
+// migrações de cada ciclo, num arquivo por rank (<arquivo>.<rank>). O laço de agentes só anota os
+// eventos nos buffers das threads; no fim do ciclo o lote vai para uma EscritoraAssincrona, que o
+// ordena, comprime e grava fora do caminho do ciclo.
+//
+// Formato: uma linha de texto de cabeçalho,
+//
+//     trabalho2-linhagem rank=<r> bits_sequencia=<B>
+//
+// seguida de um bloco por ciclo que teve eventos, com todos os inteiros em LEB128 (7 bits por byte):
+//
+//     ciclo, bytes do resto do bloco,
+//     contagens de nascimentos, mortes, migrações para cima e migrações para baixo,
+//     nascimentos em ordem crescente do filho: delta do filho e delta do pai (zigue-zague),
+//     mortes, migrações para cima, migrações para baixo: deltas dos ids em ordem crescente
+//
+// Os deltas recomeçam de 0 em cada seção. Com ids densos, um evento ocupa poucos bytes contra
+// os 9 (17 no nascimento) de um registro cru. O script linhagem.py decodifica os arquivos.
+class LogLinhagem {
+private:
+    struct Lote {
+        int ciclo;
+        std::vector<EventoLinhagem> eventos;
+    };
+
+    std::ofstream arquivo;
+    std::vector<char> buffer;
+    std::mutex mutex_livres;
+    std::vector<std::vector<EventoLinhagem>> livres; // Vetores já gravados, devolvidos com a capacidade
+    long long eventos_gravados;  // Só a escritora atualiza (lidos depois de fechá-la)
+    long long bytes_gravados;
+    std::vector<unsigned char> corpo, bloco; // Rascunhos da escritora
+    EscritoraAssincrona<Lote> escritora;      // Por último: encerra antes dos membros que usa
+
+    void gravar(std::vector<Lote>& lotes);
+    void comprimir(Lote& lote);
+
+public:
+    // Se o arquivo não abrir, ok() fica false
+    LogLinhagem(const std::string& caminho, int rank);
+    ~LogLinhagem();
+
+    LogLinhagem(const LogLinhagem&) = delete;
+    LogLinhagem& operator=(const LogLinhagem&) = delete;
+
+    bool ok() const { return arquivo.is_open(); }
+
+    // Entrega os eventos do ciclo à escritora, trocando `eventos` por um vetor vazio reaproveitado
+    // (sem copiar os eventos)
+    void registrar(int ciclo, std::vector<EventoLinhagem>& eventos);
+
+    // Espera a escritora gravar o que falta e fecha o arquivo. Devolve os eventos gravados e o
+    // tamanho do arquivo. Chamadas seguintes (e o destrutor) não fazem nada.
+    void fechar(long long& eventos, long long& bytes);
+};
+
+#endif // LINHAGEM_HPP
@@ -6,56 +6,257 @@
 #include <omp.h>
 #include <iomanip>
 #include <string>
+#include <algorithm>
 #include "territorio.hpp"
 #include "agente.hpp"
 #include "config.hpp"
+#include "comunicacao.hpp"
+#include "arena.hpp"
+#include "kernel_agentes.hpp"
+#include "metricas.hpp"
+#include "bloco_temporal.hpp"
+#include "parametros.hpp"
+#include "densidade.hpp"
+#include "ensemble.hpp"
+#include "saida_metricas.hpp"
+#include "estrategia_agentes.hpp"
+#include "regras.hpp"
+#include "servico.hpp"
+#include "rastro.hpp"
+#include "piramide.hpp"
+#include "identidade.hpp"
+#include "linhagem.hpp"
 
 // Protótipos das funções auxiliares
-std::vector<Agente> inicializar_agentes_locais(int size, int rank, int local_width, int local_height, int local_offsetX, int local_offsetY);
-void trocar_halos_territorio(Territorio& subgrid, int local_width, MPI_Datatype mpi_celula, int rank, int size);
-void processar_agentes(const std::vector<Agente>& agentes_locais, Territorio& subgrid, int local_offsetX, int local_offsetY, int local_width, int local_height, int rank, int size, std::vector<Agente>& nova_lista_local, std::vector<Agente>& buffer_envio_cima, std::vector<Agente>& buffer_envio_baixo, int& mortes_ciclo, int& nascimentos_ciclo);
-void migrar_agentes_entre_processos(int rank, int size, MPI_Datatype mpi_agente, std::vector<Agente>& agentes_locais, std::vector<Agente>& nova_lista_local, std::vector<Agente>& buffer_envio_cima, std::vector<Agente>& buffer_envio_baixo);
-void coletar_e_imprimir_metricas(int rank, int t, Estacao estacao_atual, const std::vector<Agente>& agentes_locais, Territorio& subgrid, int local_migracao, float local_consumo, float local_regeneracao, int local_mortes, int local_nascimentos, long long& volume_migracao_total);
+void trocar_halos_territorio(MPI_Comm comm, Territorio& subgrid, int local_width, JanelaTerritorio* janela, int rank, int size);
+void processar_agentes(VetorAgentes& agentes_locais, IdsLocais& ids_locais, std::vector<int>& inicio_faixa, Territorio& subgrid, CanalMigracao* canal, ArenaCiclo& arena, SeletorEstrategia& seletor, TemposFases& tempos, MetricasLocaisCiclo& metricas, int ciclo, LogLinhagem* linhagem);
+void reduzir_e_imprimir_metricas(MPI_Comm comm, int rank, const Parametros& parametros, int t_inicial, const Estacao* estacoes, const MetricasLocaisCiclo* metricas, int num_ciclos, long long& volume_migracao_total, SaidaMetricas* saida, BuffersReducaoMetricas& buffers);
+void reduzir_e_imprimir_tempos(MPI_Comm comm, int rank, double tempo_total, const TemposFases& tempos, Ensemble* ensemble);
+void simular_em_blocos(MPI_Comm comm, int rank, int size, const Parametros& parametros, const PerfilDensidade& perfil, const Cenario& cenario, Ensemble* ensemble, SaidaMetricas* saida, int local_width, int local_height, int local_offsetX, int local_offsetY);
+void simular_memoria_compartilhada(const Parametros& parametros, const PerfilDensidade& perfil, const Cenario& cenario, Ensemble* ensemble, SaidaMetricas* saida);
+void encerrar(Ensemble* ensemble, const std::vector<Cenario>& cenarios, SaidaMetricas* saida_final);
+LogLinhagem* abrir_linhagem(const Parametros& parametros, int rank);
+void encerrar_linhagem(MPI_Comm comm, int rank, LogLinhagem* linhagem, bool imprime);
 
 int main(int argc, char** argv) {
     int rank, size;
     
-    // Inicialização do MPI
-    MPI_Init(&argc, &argv);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    // Inicialização do MPI com suporte a threads: a migração pode ser progredida por uma thread
+    // de comunicação dedicada enquanto as threads OpenMP processam os agentes.
+    // MPI_THREAD_SERIALIZED basta pelo contrato do CanalMigracao (comunicacao.hpp): entre
+    // iniciar_ciclo e o retorno de finalizar_ciclo, só a thread de comunicação chama o MPI (as
+    // threads OpenMP, inclusive a principal, não fazem chamada MPI nenhuma, nem MPI_Wtime); fora
+    // dessa janela ela fica parada e só a thread principal chama o MPI. Pedimos MULTIPLE mesmo assim.
+    int nivel_thread = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &nivel_thread);
+    int rank_mundo, size_mundo;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_mundo);
+    MPI_Comm_size(MPI_COMM_WORLD, &size_mundo);
+    rank = rank_mundo;
+    size = size_mundo;
+
+    // Tamanho do problema: padrões de config.hpp, sobrescritos por --largura/--altura/--agentes/--ciclos
+    Parametros parametros;
+    std::string erro_parametros;
+    if (!ler_parametros(argc, argv, parametros, erro_parametros)) {
+        if (rank_mundo == 0) std::cerr << "Parâmetros inválidos: " << erro_parametros << std::endl
+                                 << "Uso: " << argv[0] << " [--largura L] [--altura A] [--agentes N] [--ciclos C]"
+                                 << " [--densidade uniforme|tipos|<mapa>] [--cenarios <arquivo>]"
+                                 << " [--metricas console|csv|jsonl[:<arquivo>]] [--intervalo-metricas K] [--metricas-por-rank] [--servico]"
+                                 << " [--linhagem <arquivo>]" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Ensemble: com --cenarios, MPI_COMM_WORLD é dividido entre os cenários e cada um roda a
+    // simulação no seu comunicador (`comm`), com as suas regras; sem ele, um só cenário (o padrão)
+    std::vector<Cenario> cenarios(1);
+    Ensemble* ensemble = nullptr;
+    if (!parametros.cenarios.empty()) {
+        if (!carregar_cenarios(parametros.cenarios, cenarios, erro_parametros)) {
+            if (rank_mundo == 0) std::cerr << "Cenários inválidos: " << erro_parametros << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (size_mundo % (int)cenarios.size() != 0) {
+            if (rank_mundo == 0) std::cerr << "O número de processos (" << size_mundo << ") precisa ser múltiplo do número de cenários ("
+                                     << cenarios.size() << ")" << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        ensemble = new Ensemble(MPI_COMM_WORLD, (int)cenarios.size());
+    }
+
+    // O modo serviço atende um cenário só, pelo caminho ciclo a ciclo (com 1 processo, o caminho
+    // MPI dá o mesmo resultado do modo só OpenMP)
+    if (parametros.servico && (ensemble || Config::PROFUNDIDADE_BLOCO_TEMPORAL > 1)) {
+        if (rank_mundo == 0) std::cerr << "--servico não combina com --cenarios nem com PROFUNDIDADE_BLOCO_TEMPORAL > 1" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // A linhagem segue os ids do caminho ciclo a ciclo (a blocagem temporal não mantém ids) e
+    // nomeia os arquivos pelo rank, que se repetiria entre os cenários de um ensemble
+    if (!parametros.linhagem.empty() && (!Config::IDS_AGENTES || ensemble || Config::PROFUNDIDADE_BLOCO_TEMPORAL > 1)) {
+        if (rank_mundo == 0) std::cerr << "--linhagem exige IDS_AGENTES e não combina com --cenarios nem com PROFUNDIDADE_BLOCO_TEMPORAL > 1" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Comm comm = ensemble ? ensemble->get_comm() : MPI_COMM_WORLD;
+    const Cenario& cenario = cenarios[ensemble ? ensemble->get_indice() : 0];
+    Regras::atuais = cenario.regras;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Destino das métricas, só no rank 0 do mundo. No ensemble, o líder de cada cenário registra
+    // no próprio Ensemble e o destino recebe o fluxo combinado no fim.
+    SaidaMetricas* saida_final = nullptr;
+    if (rank_mundo == 0) {
+        std::vector<std::string> nomes_cenarios;
+        for (const Cenario& c : cenarios) nomes_cenarios.push_back(c.nome);
+        std::string destino = !parametros.metricas.empty() ? parametros.metricas : (ensemble ? "csv" : "console");
+        saida_final = criar_saida_metricas(destino, nomes_cenarios, (float)parametros.largura_grid * parametros.altura_grid,
+                                           erro_parametros);
+        if (saida_final == nullptr) {
+            std::cerr << "Métricas: " << erro_parametros << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    SaidaMetricas* saida = rank != 0 ? nullptr : ensemble ? static_cast<SaidaMetricas*>(ensemble) : saida_final;
+
+    if (ensemble && rank_mundo == 0) {
+        std::cout << "Ensemble: " << cenarios.size() << " cenários x " << size << " processos" << std::endl;
+        for (const Cenario& c : cenarios) {
+            std::cout << "  " << c.nome << ": threshold_reproducao=" << c.regras.threshold_reproducao
+                      << " taxa_regeneracao_cheia=" << c.regras.taxa_regeneracao_cheia
+                      << " taxa_regeneracao_seca=" << c.regras.taxa_regeneracao_seca
+                      << " fator_carga_trabalho=" << c.regras.fator_carga_trabalho
+                      << " semente=" << c.semente << std::endl;
+        }
+    }
+
+    if (parametros.altura_grid % size != 0) {
+        if (rank_mundo == 0) std::cerr << "A altura do grid (" << parametros.altura_grid << ") precisa ser múltipla do número de processos ("
+                                 << size << ")" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // A troca de bordas da pirâmide só alcança os vizinhos imediatos
+    if (Config::PERCEPCAO_ESTENDIDA && size > 1 && parametros.altura_grid / size < PiramideRecursos::altura_minima()) {
+        if (rank_mundo == 0) std::cerr << "PERCEPCAO_ESTENDIDA exige faixas de pelo menos " << PiramideRecursos::altura_minima()
+                                 << " linhas por processo" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Perfil de densidade da população inicial (todos os ranks leem o mesmo mapa, se houver)
+    PerfilDensidade perfil;
+    if (!PerfilDensidade::carregar(parametros.densidade, parametros.largura_grid, parametros.altura_grid, perfil, erro_parametros)) {
+        if (rank_mundo == 0) std::cerr << "Perfil de densidade inválido: " << erro_parametros << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Autoverificação opcional: o kernel em lote precisa reproduzir o escalar bit a bit
+    if (Config::VERIFICAR_KERNEL_LOTE && rank_mundo == 0) {
+        bool ok = verificar_kernel_lote();
+        std::cout << "Verificação do kernel em lote (lote x escalar): " << (ok ? "OK" : "FALHOU") << std::endl;
+        if (!ok) MPI_Abort(MPI_COMM_WORLD, 1);
+    }
     
     // Divisão do subgrid local (Simplificada: divisão 1D nas linhas do Grid Global)
     // Para simplificar a demonstração, o particionamento será efetuado pelo número de processos
-    int local_height = Config::ALTURA_GRID / size;
+    int local_height = parametros.altura_grid / size;
     int local_offsetY = rank * local_height;
-    int local_width = Config::LARGURA_GRID; 
+    int local_width = parametros.largura_grid;
     int local_offsetX = 0;
+
+    // Um processo só (ex.: um nó grande com muitas threads, ou o build sem MPI): a grade inteira
+    // fica num único Territorio e o ciclo roda só com OpenMP, sem halos nem migração
+    if (Config::UM_PROCESSO_SO_OPENMP && size == 1 && !parametros.servico) {
+        simular_memoria_compartilhada(parametros, perfil, cenario, ensemble, saida);
+        encerrar(ensemble, cenarios, saida_final);
+        return 0;
+    }
+
+    // Blocagem temporal: halos profundos e sincronização com os vizinhos só a cada
+    // PROFUNDIDADE_BLOCO_TEMPORAL ciclos (sem janela compartilhada nem canal de migração)
+    if (Config::PROFUNDIDADE_BLOCO_TEMPORAL > 1) {
+        simular_em_blocos(comm, rank, size, parametros, perfil, cenario, ensemble, saida, local_width, local_height, local_offsetX, local_offsetY);
+        encerrar(ensemble, cenarios, saida_final);
+        return 0;
+    }
     
+    // Ranks do mesmo nó alocam suas faixas numa janela MPI-3 compartilhada para lerem os halos
+    // uns dos outros in loco; só vizinhos em nós diferentes trocam halos por mensagem
+    JanelaTerritorio* janela = nullptr;
+    if (Config::HALO_MEMORIA_COMPARTILHADA) {
+        janela = new JanelaTerritorio(comm, rank, size, Territorio::floats_com_borda(local_width, local_height));
+    }
+
     // Instancia o território local particionado
-    Territorio subgrid(local_width, local_height, Posicao(local_offsetX, local_offsetY));
+    Territorio subgrid(local_width, local_height, Posicao(local_offsetX, local_offsetY),
+                       janela ? janela->memoria_local() : nullptr);
     Estacao estacao_atual = Estacao::SECA;
     
     // Inicialização OpenMP paralela (First Touch Policy)
     subgrid.inicializar(estacao_atual);
-    subgrid.alocar_halos(rank > 0, rank < size - 1);
-    
-    srand(Config::SEED); // Seed por processo para garantir reprodutibilidade na execução 
+
+    // Pirâmide de recursos da percepção estendida, reconstruída a cada atualização de recursos
+    PiramideRecursos* piramide = nullptr;
+    if (Config::PERCEPCAO_ESTENDIDA) {
+        piramide = new PiramideRecursos(parametros.largura_grid, parametros.altura_grid, local_offsetY, local_height);
+        piramide->atualizar(subgrid, comm, rank, size);
+        subgrid.usar_piramide(piramide);
+    }
+
+    // Halos de vizinhos no mesmo nó: a linha de borda deles é copiada direto da janela para a
+    // linha fantasma a cada ciclo (sem mensagem); os demais chegam por MPI na própria linha fantasma
+    if (janela && janela->compartilha_com(Direcao::CIMA)) {
+        // Halo superior = última linha da faixa do vizinho de cima
+        subgrid.usar_halo_sup_externo(janela->memoria_vizinho(Direcao::CIMA) +
+                                      Territorio::deslocamento_linha(local_width, local_height - 1));
+    }
+    if (janela && janela->compartilha_com(Direcao::BAIXO)) {
+        // Halo inferior = primeira linha da faixa do vizinho de baixo
+        subgrid.usar_halo_inf_externo(janela->memoria_vizinho(Direcao::BAIXO) +
+                                      Territorio::deslocamento_linha(local_width, 0));
+    }
     
-    // Inicializar agentes locais
-    std::vector<Agente> agentes_locais = inicializar_agentes_locais(size, rank, local_width, local_height, local_offsetX, local_offsetY);
+    // Tempo por fase (relatório de desempenho ao final)
+    TemposFases tempos;
+
+    // População inicial criada em paralelo a partir do perfil de densidade (mesma semente em todos
+    // os ranks: cada agente sorteia sua célula pelo próprio índice global)
+    // Os ids (IDS_AGENTES) ficam num array frio paralelo, fora do laço quente
+    double marca_inicio = omp_get_wtime();
+    IdsLocais ids_locais(rank);
+    VetorAgentes agentes_locais = inicializar_agentes(comm, perfil, parametros.num_agentes, local_width, local_height,
+                                                      Posicao(local_offsetX, local_offsetY), cenario.semente, ids_locais.vetor());
+    tempos.inicializacao = omp_get_wtime() - marca_inicio;
+
+    // Agentes agrupados pela faixa de linhas de cada thread (a mesma do first-touch do subgrid):
+    // cada thread processa os agentes que vivem nas páginas da grade que ela mesma tocou
+    ArenaCiclo arena;
+    SeletorEstrategia seletor;
+    std::vector<int> inicio_faixa;
+    agrupar_agentes_por_faixa(agentes_locais, arena.auxiliar_faixas, arena.cursor_faixas, inicio_faixa, subgrid,
+                              ids_locais.vetor(), &arena.auxiliar_ids);
+    LogLinhagem* linhagem = abrir_linhagem(parametros, rank);
     
-    // Criar datatypes MPI para as estruturas
-    MPI_Datatype mpi_celula;
-    MPI_Type_contiguous(sizeof(Celula), MPI_BYTE, &mpi_celula);
-    MPI_Type_commit(&mpi_celula);
-
-    MPI_Datatype mpi_agente;
-    MPI_Type_contiguous(sizeof(Agente), MPI_BYTE, &mpi_agente);
-    MPI_Type_commit(&mpi_agente);
+    // Os halos só levam o plano de recurso (MPI_FLOAT); os agentes migrantes não usam datatype: trafegam no formato compacto de FormatoMigracao
+    if (local_width > FormatoMigracao::LARGURA_MAXIMA) {
+        if (rank_mundo == 0) std::cerr << "LARGURA_GRID excede o limite do formato de migração ("
+                                 << FormatoMigracao::LARGURA_MAXIMA << ")" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Canal de migração em lotes (thread de progresso só se o MPI suportar chamadas de outra thread;
+    // com SERIALIZED, vale o contrato de chamadas MPI descrito em comunicacao.hpp)
+    bool usar_thread_comunicacao = Config::THREAD_COMUNICACAO && nivel_thread >= MPI_THREAD_SERIALIZED;
+    CanalMigracao* canal = new CanalMigracao(comm, rank, size, local_offsetY, local_offsetY + local_height - 1,
+                                             usar_thread_comunicacao);
     
-    if (rank == 0) {
+    // Com ensemble, os líderes dos cenários não imprimem: o relatório sai combinado no fim
+    bool imprime = rank == 0 && !ensemble;
+    if (imprime) {
         std::cout << "Simulação Sazonal Indígena inicializada com " << size << " processos." << std::endl;
+        std::cout << "Thread de comunicação MPI: " << (usar_thread_comunicacao ? "ativa" : "inativa")
+                  << " (nível de thread fornecido: " << nivel_thread << ")" << std::endl;
+        std::cout << "Halos via memória compartilhada do nó: " << (janela ? "ativos" : "inativos") << std::endl;
+        std::cout << "População inicial: " << parametros.num_agentes << " agentes (perfil " << perfil.get_nome() << ")" << std::endl;
         #pragma omp parallel
         {
             #pragma omp single
@@ -64,9 +265,10 @@ int main(int argc, char** argv) {
     }
     
     long long volume_migracao_total = 0;
-    
-    // Simulação principal
-    for (int t = 0; t < Config::TOTAL_CICLOS; ++t) {
+    BuffersReducaoMetricas buffers_metricas(rank, size, parametros.metricas_por_rank);
+
+    // Um ciclo da simulação principal (o laço abaixo, ou os comandos `ciclos` do modo serviço)
+    auto avancar_ciclo = [&](int t) {
         // 5.1 Atualizar estação
         if (t > 0 && t % Config::TAMANHO_CICLO_SAZONAL == 0) {
             estacao_atual = (estacao_atual == Estacao::SECA) ? Estacao::CHEIA : Estacao::SECA;
@@ -74,85 +276,151 @@ int main(int argc, char** argv) {
         }
         
         // 5.2 Troca de halo MPI
-        trocar_halos_territorio(subgrid, local_width, mpi_celula, rank, size);
-        
-        // 5.3 Processar agentes com OpenMP
-        std::vector<Agente> buffer_envio_cima;
-        std::vector<Agente> buffer_envio_baixo;
-        std::vector<Agente> nova_lista_local;
-
-        int local_mortes = 0;
-        int local_nascimentos = 0;
-        processar_agentes(agentes_locais, subgrid, local_offsetX, local_offsetY, local_width, local_height, rank, size, nova_lista_local, buffer_envio_cima, buffer_envio_baixo, local_mortes, local_nascimentos);
+        double marca = omp_get_wtime();
+        trocar_halos_territorio(comm, subgrid, local_width, janela, rank, size);
+        tempos.halo += Rastro::fechar_fase("halo", marca);
         
-        int local_migracao = buffer_envio_cima.size() + buffer_envio_baixo.size();
-        
-        // 5.4 Migração de agentes com MPI
-        migrar_agentes_entre_processos(rank, size, mpi_agente, agentes_locais, nova_lista_local, buffer_envio_cima, buffer_envio_baixo);
-
-        // 5.5 Calcular métricas de consumo e regeneração antes de atualizar (e zerar) o consumo
-        float local_consumo = subgrid.get_consumo_total();
-        float local_regeneracao = subgrid.get_regeneracao_total(estacao_atual);
+        // 5.3 + 5.4 Agentes e migração numa só região paralela: laço de agentes (os migrantes já
+        // saem em lotes pelo canal), conclusão da migração pela thread principal e reagrupamento
+        // por faixa. As métricas dos agentes saem do próprio laço
+        MetricasLocaisCiclo metricas;
+        canal->iniciar_ciclo();
+        processar_agentes(agentes_locais, ids_locais, inicio_faixa, subgrid, canal, arena, seletor, tempos, metricas, t, linhagem);
 
-        // 5.6 Atualizar grid local via OpenMP paralelizável
-        subgrid.atualizar_recursos(estacao_atual);
+        // 5.5 + 5.6 Atualizar o grid local numa só varredura, que devolve o consumo do ciclo e
+        // os recursos resultantes
+        marca = omp_get_wtime();
+        BalancoRecursos balanco = subgrid.atualizar_recursos_com_balanco(estacao_atual);
+        metricas.consumo = balanco.consumo;
+        metricas.recursos = balanco.recursos;
+        metricas.regeneracao = subgrid.get_regeneracao_total(estacao_atual);
+        if (piramide) piramide->atualizar(subgrid, comm, rank, size);
+        tempos.recursos += Rastro::fechar_fase("recursos", marca);
         
         // 5.7 Métricas globais
-        coletar_e_imprimir_metricas(rank, t, estacao_atual, agentes_locais, subgrid,
-                                    local_migracao, local_consumo, local_regeneracao,
-                                    local_mortes, local_nascimentos, volume_migracao_total);
+        marca = omp_get_wtime();
+        reduzir_e_imprimir_metricas(comm, rank, parametros, t, &estacao_atual, &metricas, 1, volume_migracao_total, saida, buffers_metricas);
 
         // 5.7 Barreira MPI por garantia de ciclo síncrono
-        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Barrier(comm);
+        tempos.metricas += Rastro::fechar_fase("metricas", marca);
+    };
+
+    MPI_Barrier(comm);
+    Rastro::iniciar(rank_mundo);
+    double tempo_total = 0.0;
+    if (parametros.servico) {
+        // O estado fica residente entre os comandos; o tempo total é só o dos ciclos
+        if (imprime) {
+            std::cout << "Modo serviço: aguardando comandos (ciclos N, regras chave=valor..., recursos x0 y0 x1 y1,"
+                      << " estado, snapshot <arquivo>, sair)" << std::endl;
+        }
+        int ciclo = 0;
+        tempo_total = atender_comandos(comm, rank, parametros, ciclo, subgrid, agentes_locais, saida, avancar_ciclo);
+    } else {
+        double inicio_simulacao = omp_get_wtime();
+        for (int t = 0; t < parametros.total_ciclos; ++t) avancar_ciclo(t);
+        // O que a escrita assíncrona ainda não terminou entra no tempo total
+        if (saida) saida->esvaziar();
+        tempo_total = omp_get_wtime() - inicio_simulacao;
     }
+    Rastro::finalizar();
     
-    MPI_Type_free(&mpi_celula);
-    MPI_Type_free(&mpi_agente);
+    // Pico de buffers do pool de migração (memória de envio limitada mesmo em migração em massa)
+    int pico_lotes_local = canal->get_pico_lotes();
+    int pico_lotes_global = 0;
+    MPI_Reduce(&pico_lotes_local, &pico_lotes_global, 1, MPI_INT, MPI_MAX, 0, comm);
+
+    // Pico da arena de ciclo e ciclos (após o primeiro) em que ela ainda precisou crescer
+    long long arena_local[2] = {(long long)arena.get_pico_bytes(), arena.get_ciclos_com_crescimento()};
+    long long arena_global[2] = {0, 0};
+    MPI_Reduce(arena_local, arena_global, 2, MPI_LONG_LONG, MPI_MAX, 0, comm);
+
+    // O canal (e sua thread) e a janela compartilhada precisam ser destruídos antes de finalizar o MPI
+    delete canal;
+    delete janela;
+    delete piramide;
+    encerrar_linhagem(comm, rank, linhagem, imprime);
+
     
-    if (rank == 0) {
+    if (imprime) {
+        std::cout << "Pico do pool de migração: " << pico_lotes_global << " lotes de "
+                  << Config::TAMANHO_LOTE_MIGRACAO << " agentes por processo" << std::endl;
+        std::cout << "Pico da arena de ciclo: " << arena_global[0] / 1024 << " KiB por processo ("
+                  << arena_global[1] << " ciclos com crescimento após o aquecimento)" << std::endl;
         std::cout << "Simulacao concluida." << std::endl;
     }
+    reduzir_e_imprimir_tempos(comm, rank, tempo_total, tempos, ensemble);
     
-    MPI_Finalize();
+    encerrar(ensemble, cenarios, saida_final);
     return 0;
 }
 
-std::vector<Agente> inicializar_agentes_locais(int size, int rank, int local_width, int local_height, int local_offsetX, int local_offsetY) 
-{
-    int local_agents_count = Config::N_AGENTS / size;
-    std::vector<Agente> agentes;
-    
-    // Otimização: reserva o espaço no vetor de uma vez para evitar múltiplas realocações
-    agentes.reserve(local_agents_count); 
-    
-    for (int i = 0; i < local_agents_count; ++i) {
-        // Gera coordenadas globais aleatórias dentro do subgrid local deste processo
-        int gx = rand() % local_width + local_offsetX;
-        int gy = rand() % local_height + local_offsetY;
-        
-        // Cria o agente com uma posição global aleatória
-        agentes.push_back(Agente(Posicao(gx, gy), Config::ENERGIA_INICIAL_AGENTE));
+// Log de linhagem do rank (--linhagem), ou nullptr sem ele. Aborta se o arquivo não abrir.
+LogLinhagem* abrir_linhagem(const Parametros& parametros, int rank) {
+    if (parametros.linhagem.empty()) return nullptr;
+    LogLinhagem* linhagem = new LogLinhagem(parametros.linhagem, rank);
+    if (!linhagem->ok()) {
+        std::cerr << "Não consegui criar o log de linhagem " << parametros.linhagem << "." << rank << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return linhagem;
+}
+
+// Fecha o log de linhagem de cada rank (a escritora grava o que falta) e informa no rank 0 os
+// eventos gravados e o tamanho dos arquivos
+void encerrar_linhagem(MPI_Comm comm, int rank, LogLinhagem* linhagem, bool imprime) {
+    if (!linhagem) return;
+    long long local[2] = {0, 0};
+    long long global[2] = {0, 0};
+    linhagem->fechar(local[0], local[1]);
+    delete linhagem;
+    MPI_Reduce(local, global, 2, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    if (imprime && rank == 0) {
+        std::cout << "Linhagem: " << global[0] << " eventos em " << global[1] << " bytes ("
+                  << std::fixed << std::setprecision(2) << (global[0] > 0 ? (double)global[1] / global[0] : 0.0)
+                  << " bytes por evento)" << std::endl;
     }
-    
-    return agentes;
+}
+
+// Fim da execução: com ensemble, passa o fluxo combinado de todos os cenários ao destino das
+// métricas (coletiva em MPI_COMM_WORLD) e libera os comunicadores; o destino (e sua thread
+// escritora) é liberado antes de finalizar o MPI
+void encerrar(Ensemble* ensemble, const std::vector<Cenario>& cenarios, SaidaMetricas* saida_final) {
+    if (ensemble) {
+        ensemble->imprimir_fluxo_combinado(MPI_COMM_WORLD, cenarios, saida_final);
+        delete ensemble;
+    }
+    delete saida_final;
+    MPI_Finalize();
 }
 
 // Função auxiliar para trocar halos entre processos
 // Otimizada para ser não bloqueante
-void trocar_halos_territorio(Territorio& subgrid, int local_width, MPI_Datatype mpi_celula, int rank, int size) {
+// Vizinhos no mesmo nó (janela compartilhada) não trocam mensagens: basta sincronizar para
+// enxergar a atualização de recursos do ciclo anterior e copiar a borda deles para a linha fantasma
+void trocar_halos_territorio(MPI_Comm comm, Territorio& subgrid, int local_width, JanelaTerritorio* janela, int rank, int size) {
     MPI_Request reqs[4];
     int num_reqs = 0;
+
+    bool sup_compartilhado = false, inf_compartilhado = false;
+    if (janela) {
+        janela->sincronizar();
+        subgrid.copiar_halos_externos();
+        sup_compartilhado = janela->compartilha_com(Direcao::CIMA);
+        inf_compartilhado = janela->compartilha_com(Direcao::BAIXO);
+    }
     
     // Recebe do vizinho de cima e envia sua borda superior para ele
-    if (rank > 0) {
-        MPI_Irecv(subgrid.ptr_halo_sup(), local_width, mpi_celula, rank - 1, 0, MPI_COMM_WORLD, &reqs[num_reqs++]);
-        MPI_Isend(subgrid.ptr_linha_sup(), local_width, mpi_celula, rank - 1, 1, MPI_COMM_WORLD, &reqs[num_reqs++]);
+    if (rank > 0 && !sup_compartilhado) {
+        MPI_Irecv(subgrid.ptr_halo_sup(), local_width, MPI_FLOAT, rank - 1, 0, comm, &reqs[num_reqs++]);
+        MPI_Isend(subgrid.ptr_linha_sup(), local_width, MPI_FLOAT, rank - 1, 1, comm, &reqs[num_reqs++]);
     }
     
     // Recebe do vizinho de baixo e envia sua borda inferior para ele
-    if (rank < size - 1) {
-        MPI_Irecv(subgrid.ptr_halo_inf(), local_width, mpi_celula, rank + 1, 1, MPI_COMM_WORLD, &reqs[num_reqs++]);
-        MPI_Isend(subgrid.ptr_linha_inf(), local_width, mpi_celula, rank + 1, 0, MPI_COMM_WORLD, &reqs[num_reqs++]);
+    if (rank < size - 1 && !inf_compartilhado) {
+        MPI_Irecv(subgrid.ptr_halo_inf(), local_width, MPI_FLOAT, rank + 1, 1, comm, &reqs[num_reqs++]);
+        MPI_Isend(subgrid.ptr_linha_inf(), local_width, MPI_FLOAT, rank + 1, 0, comm, &reqs[num_reqs++]);
     }
     
     // Aguarda todas as comunicações não-bloqueantes terminarem antes de prosseguir
@@ -161,247 +429,525 @@ void trocar_halos_territorio(Territorio& subgrid, int local_width, MPI_Datatype
     }
 }
 
-void processar_agentes(
-    const std::vector<Agente>& agentes_locais,
-    Territorio& subgrid,
-    int local_offsetX, int local_offsetY,
-    int local_width, int local_height,
-    int rank, int size,
-    std::vector<Agente>& nova_lista_local,
-    std::vector<Agente>& buffer_envio_cima,
-    std::vector<Agente>& buffer_envio_baixo,
-    int& mortes_ciclo,
-    int& nascimentos_ciclo) 
-{
-    // Limpa os buffers para a nova iteração
-    nova_lista_local.clear();
-    buffer_envio_cima.clear();
-    buffer_envio_baixo.clear();
-    
-    int total_mortes = 0;
-    int total_nascimentos = 0;
+void simular_em_blocos(MPI_Comm comm, int rank, int size, const Parametros& parametros, const PerfilDensidade& perfil,
+                       const Cenario& cenario, Ensemble* ensemble, SaidaMetricas* saida, int local_width, int local_height, int local_offsetX, int local_offsetY) {
+    const int profundidade = Config::PROFUNDIDADE_BLOCO_TEMPORAL;
+
+    // Os halos de 3k linhas vêm inteiros do vizinho imediato
+    if (3 * profundidade > local_height) {
+        if (rank == 0) std::cerr << "PROFUNDIDADE_BLOCO_TEMPORAL exige halos de " << 3 * profundidade
+                                 << " linhas, maiores que a faixa de cada processo (" << local_height << ")" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
-    #pragma omp parallel reduction(+:total_mortes, total_nascimentos)
+    // Mesma população inicial do modo ciclo a ciclo
+    TemposFases tempos;
+    double marca_inicio = omp_get_wtime();
+    VetorAgentes agentes_locais = inicializar_agentes(comm, perfil, parametros.num_agentes, local_width, local_height,
+                                                      Posicao(local_offsetX, local_offsetY), cenario.semente);
+    tempos.inicializacao = omp_get_wtime() - marca_inicio;
+
+    ArenaCiclo arena;
+    Estacao estacao_atual = Estacao::SECA;
+    long long sincronizacoes_local = 0;
+    double tempo_total = 0.0;
     {
-        // Vetores privados para cada thread (evita contenção no início)
-        std::vector<Agente> envio_cima_thread;
-        std::vector<Agente> envio_baixo_thread;
-        std::vector<Agente> lista_local_thread;
-
-        #pragma omp for
-        for (int i = 0; i < (int)agentes_locais.size(); ++i) {
-            Agente a_atualizado = agentes_locais[i];
-            Posicao celula_atual = a_atualizado.get_posicao();
-            int lnx = celula_atual.x - local_offsetX;
-            int lny = celula_atual.y - local_offsetY;
-            
-            float r = 0;
-            if(lny >= 0 && lny < local_height && lnx >= 0 && lnx < local_width) {
-                 r = subgrid.get_celula(Posicao(lnx, lny)).recurso;
-            }
-            
-            // 1. Executa carga de trabalho e CONSOME energia (Agora afeta o agente)
-            a_atualizado.executar_carga(r);
-            
-            // 2. Verifica se o agente ainda está vivo
-            if (a_atualizado.get_energia() <= 0) {
-                total_mortes++;
-                continue; // O agente morreu e não será adicionado a nenhuma lista
+        BlocoTemporal bloco(comm, rank, size, local_width, local_height, profundidade, arena);
+        bloco.inicializar(estacao_atual, std::move(agentes_locais));
+
+        if (rank == 0 && !ensemble) {
+            std::cout << "Simulação Sazonal Indígena inicializada com " << size << " processos." << std::endl;
+            std::cout << "Blocagem temporal: sincronização a cada " << profundidade << " ciclos (halos de "
+                      << bloco.get_halo() << " linhas)" << std::endl;
+            std::cout << "População inicial: " << parametros.num_agentes << " agentes (perfil " << perfil.get_nome() << ")" << std::endl;
+            #pragma omp parallel
+            {
+                #pragma omp single
+                std::cout << "OpenMP Threads disponiveis por MPI rank: " << omp_get_num_threads() << std::endl;
             }
+        }
 
-            // 3. Se vivo, decide o próximo passo
-            Posicao destino;
-            a_atualizado.decidir(subgrid, destino);
-            a_atualizado.set_posicao(destino);
-            
-            // Lógica de Migração ou Permanência Local
-            int dest_y = destino.y;
-            if (dest_y < local_offsetY) {
-                if (rank > 0) envio_cima_thread.push_back(a_atualizado);
-            } else if (dest_y >= local_offsetY + local_height) {
-                if (rank < size - 1) envio_baixo_thread.push_back(a_atualizado);
-            } else {
-                a_atualizado.consumir_recurso(subgrid);
-                lista_local_thread.push_back(a_atualizado);
-                
-                // 4. Verifica se o agente se reproduz após consumir recurso
-                Agente filho;
-                if (a_atualizado.reproduzir(subgrid, filho)) {
-                    lista_local_thread.push_back(filho);
-                    total_nascimentos++;
+        long long volume_migracao_total = 0;
+        std::vector<Estacao> estacoes(profundidade);
+        std::vector<MetricasLocaisCiclo> metricas(profundidade);
+        BuffersReducaoMetricas buffers_metricas(rank, size, parametros.metricas_por_rank);
+
+        MPI_Barrier(comm);
+        Rastro::iniciar(rank);
+        double inicio_simulacao = omp_get_wtime();
+
+        for (int t_bloco = 0; t_bloco < parametros.total_ciclos; t_bloco += profundidade) {
+            int ciclos = std::min(profundidade, parametros.total_ciclos - t_bloco);
+
+            // Uma troca de halos profundos e agentes de borda por bloco, no lugar de halo + migração por ciclo
+            double marca = omp_get_wtime();
+            bloco.sincronizar();
+            tempos.halo += Rastro::fechar_fase("halo", marca);
+
+            for (int c = 0; c < ciclos; ++c) {
+                int t = t_bloco + c;
+                if (t > 0 && t % Config::TAMANHO_CICLO_SAZONAL == 0) {
+                    estacao_atual = (estacao_atual == Estacao::SECA) ? Estacao::CHEIA : Estacao::SECA;
+                    bloco.atualizar_estacao(estacao_atual);
                 }
+                estacoes[c] = estacao_atual;
+                metricas[c] = bloco.avancar_ciclo(estacao_atual, tempos);
             }
-        }
 
-        // Consolidação segura (Região Crítica)
-        #pragma omp critical
-        {
-            buffer_envio_cima.insert(buffer_envio_cima.end(), envio_cima_thread.begin(), envio_cima_thread.end());
-            buffer_envio_baixo.insert(buffer_envio_baixo.end(), envio_baixo_thread.begin(), envio_baixo_thread.end());
-            nova_lista_local.insert(nova_lista_local.end(), lista_local_thread.begin(), lista_local_thread.end());
+            // Métricas do bloco inteiro numa só redução
+            marca = omp_get_wtime();
+            reduzir_e_imprimir_metricas(comm, rank, parametros, t_bloco, estacoes.data(), metricas.data(), ciclos, volume_migracao_total, saida, buffers_metricas);
+            MPI_Barrier(comm);
+            tempos.metricas += Rastro::fechar_fase("metricas", marca);
         }
+        if (saida) saida->esvaziar();
+        tempo_total = omp_get_wtime() - inicio_simulacao;
+        Rastro::finalizar();
+        sincronizacoes_local = bloco.get_sincronizacoes();
     }
-    
-    mortes_ciclo = total_mortes;
-    nascimentos_ciclo = total_nascimentos;
+
+    long long arena_local[2] = {(long long)arena.get_pico_bytes(), arena.get_ciclos_com_crescimento()};
+    long long arena_global[2] = {0, 0};
+    MPI_Reduce(arena_local, arena_global, 2, MPI_LONG_LONG, MPI_MAX, 0, comm);
+
+
+    if (rank == 0 && !ensemble) {
+        std::cout << "Sincronizações com os vizinhos: " << sincronizacoes_local << " em "
+                  << parametros.total_ciclos << " ciclos" << std::endl;
+        std::cout << "Pico da arena de ciclo: " << arena_global[0] / 1024 << " KiB por processo ("
+                  << arena_global[1] << " ciclos com crescimento após o aquecimento)" << std::endl;
+        std::cout << "Simulacao concluida." << std::endl;
+    }
+    reduzir_e_imprimir_tempos(comm, rank, tempo_total, tempos, ensemble);
 }
 
-void migrar_agentes_entre_processos(
-    int rank, int size, MPI_Datatype mpi_agente,
-    std::vector<Agente>& agentes_locais,
-    std::vector<Agente>& nova_lista_local,
-    std::vector<Agente>& buffer_envio_cima,
-    std::vector<Agente>& buffer_envio_baixo) 
-{
-    int recv_cima_size = 0, recv_baixo_size = 0;
-    int send_cima_size = buffer_envio_cima.size();
-    int send_baixo_size = buffer_envio_baixo.size();
-    
-    MPI_Request reqs_migr[8];
-    int num_reqs_migr = 0;
-    
-    // FASE 1: Troca de metadados (quantos agentes cada um vai mandar?)
-    if (rank > 0) {
-        // Recebe do vizinho de cima e envia sua borda superior para ele
-        MPI_Irecv(&recv_cima_size, 1, MPI_INT, rank - 1, 2, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-        MPI_Isend(&send_cima_size, 1, MPI_INT, rank - 1, 3, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-    }
-    if (rank < size - 1) {
-        // Recebe do vizinho de baixo e envia sua borda inferior para ele
-        MPI_Irecv(&recv_baixo_size, 1, MPI_INT, rank + 1, 3, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-        MPI_Isend(&send_baixo_size, 1, MPI_INT, rank + 1, 2, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-    }
-    if (num_reqs_migr > 0) {
-        // Aguarda todas as comunicações não-bloqueantes terminarem antes de prosseguir
-        MPI_Waitall(num_reqs_migr, reqs_migr, MPI_STATUSES_IGNORE);
-    } 
-    
-    // FASE 2: Troca dos agentes reais
-    std::vector<Agente> recv_buffer_cima(recv_cima_size);
-    std::vector<Agente> recv_buffer_baixo(recv_baixo_size);
-    num_reqs_migr = 0;
-    
-    if (rank > 0) {
-        if (recv_cima_size > 0) {
-            // Recebe do vizinho de cima e envia sua borda superior para ele
-            MPI_Irecv(recv_buffer_cima.data(), recv_cima_size, mpi_agente, rank - 1, 4, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-        }
-        if (send_cima_size > 0) {
-            // Recebe do vizinho de cima e envia sua borda superior para ele
-            MPI_Isend(buffer_envio_cima.data(), send_cima_size, mpi_agente, rank - 1, 5, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
-        }
+// Destino dos resultados do kernel de agentes no modo de um processo só. Não há migração: com a
+// grade inteira no Territorio, as linhas fantasmas (RECURSO_FANTASMA) nunca vencem o argmax da
+// decisão e nenhum agente sai da grade.
+struct SaidaGradeInteira {
+    std::vector<Agente>& lista_local;
+    IdsThread* ids; // Ids em paralelo a lista_local (nullptr sem IDS_AGENTES)
+    int mortes;
+    int nascimentos;
+    float energia; // Energia dos agentes que ficam (métrica do ciclo, sem outra passada)
+
+    void trecho(int inicio) { if (Config::IDS_AGENTES) ids->trecho(inicio); }
+    void morte() { mortes++; if (Config::IDS_AGENTES) ids->morte(); }
+    void migrante(Direcao, const Agente&) {}
+    void local(const Agente& a) { lista_local.push_back(a); energia += a.get_energia(); if (Config::IDS_AGENTES) ids->local(); }
+    void nascimento(const Agente& filho) {
+        lista_local.push_back(filho); nascimentos++; energia += filho.get_energia();
+        if (Config::IDS_AGENTES) ids->nascimento();
+    }
+};
+
+void simular_memoria_compartilhada(const Parametros& parametros, const PerfilDensidade& perfil, const Cenario& cenario, Ensemble* ensemble, SaidaMetricas* saida) {
+    const int largura = parametros.largura_grid;
+    const int altura = parametros.altura_grid;
+
+    Territorio grade(largura, altura, Posicao(0, 0));
+    Estacao estacao_atual = Estacao::SECA;
+    grade.inicializar(estacao_atual);
+
+    PiramideRecursos* piramide = nullptr;
+    if (Config::PERCEPCAO_ESTENDIDA) {
+        piramide = new PiramideRecursos(largura, altura, 0, altura);
+        piramide->atualizar(grade, MPI_COMM_SELF, 0, 1);
+        grade.usar_piramide(piramide);
     }
-    if (rank < size - 1) {
-        if (recv_baixo_size > 0) {
-            // Recebe do vizinho de baixo e envia sua borda inferior para ele
-            MPI_Irecv(recv_buffer_baixo.data(), recv_baixo_size, mpi_agente, rank + 1, 5, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
+
+    // Mesma população do modo com MPI em 1 processo
+    TemposFases tempos;
+    double marca_inicio = omp_get_wtime();
+    IdsLocais ids(0);
+    VetorAgentes agentes = inicializar_agentes(MPI_COMM_SELF, perfil, parametros.num_agentes, largura, altura, Posicao(0, 0),
+                                               cenario.semente, ids.vetor());
+    tempos.inicializacao = omp_get_wtime() - marca_inicio;
+
+    ArenaCiclo arena;
+    SeletorEstrategia seletor;
+    std::vector<int> inicio_faixa;
+    agrupar_agentes_por_faixa(agentes, arena.auxiliar_faixas, arena.cursor_faixas, inicio_faixa, grade, ids.vetor(), &arena.auxiliar_ids);
+    LogLinhagem* linhagem = abrir_linhagem(parametros, 0);
+
+    if (!ensemble) {
+        std::cout << "Simulação Sazonal Indígena inicializada com 1 processos." << std::endl;
+        std::cout << "Modo só OpenMP: grade inteira em um território, sem halos nem migração" << std::endl;
+        std::cout << "População inicial: " << parametros.num_agentes << " agentes (perfil " << perfil.get_nome() << ")" << std::endl;
+        #pragma omp parallel
+        {
+            #pragma omp single
+            std::cout << "OpenMP Threads disponiveis por MPI rank: " << omp_get_num_threads() << std::endl;
         }
-        if (send_baixo_size > 0) {
-            // Recebe do vizinho de baixo e envia sua borda inferior para ele
-            MPI_Isend(buffer_envio_baixo.data(), send_baixo_size, mpi_agente, rank + 1, 4, MPI_COMM_WORLD, &reqs_migr[num_reqs_migr++]);
+    }
+
+    long long volume_migracao_total = 0;
+    BuffersReducaoMetricas buffers_metricas(0, 1, parametros.metricas_por_rank);
+    Rastro::iniciar(0);
+    double inicio_simulacao = omp_get_wtime();
+
+    for (int t = 0; t < parametros.total_ciclos; ++t) {
+        if (t > 0 && t % Config::TAMANHO_CICLO_SAZONAL == 0) {
+            estacao_atual = (estacao_atual == Estacao::SECA) ? Estacao::CHEIA : Estacao::SECA;
+            grade.atualizar_acessibilidade(estacao_atual);
         }
+
+        // Agentes: mesma região do modo com MPI, sem canal (a "migração" só troca as listas)
+        MetricasLocaisCiclo metricas;
+        processar_agentes(agentes, ids, inicio_faixa, grade, nullptr, arena, seletor, tempos, metricas, t, linhagem);
+
+        double marca = omp_get_wtime();
+        BalancoRecursos balanco = grade.atualizar_recursos_com_balanco(estacao_atual);
+        metricas.consumo = balanco.consumo;
+        metricas.recursos = balanco.recursos;
+        metricas.regeneracao = grade.get_regeneracao_total(estacao_atual);
+        if (piramide) piramide->atualizar(grade, MPI_COMM_SELF, 0, 1);
+        tempos.recursos += Rastro::fechar_fase("recursos", marca);
+
+        // As reduções de um processo são cópias locais; reaproveita o mesmo relatório
+        marca = omp_get_wtime();
+        reduzir_e_imprimir_metricas(MPI_COMM_SELF, 0, parametros, t, &estacao_atual, &metricas, 1, volume_migracao_total, saida, buffers_metricas);
+        tempos.metricas += Rastro::fechar_fase("metricas", marca);
     }
-    if (num_reqs_migr > 0) MPI_Waitall(num_reqs_migr, reqs_migr, MPI_STATUSES_IGNORE);
-    
-    // FASE 3: Consolidação (Move os dados para a lista oficial)
-    agentes_locais = std::move(nova_lista_local);
-    if (!recv_buffer_cima.empty()) {
-        // Recebe do vizinho de cima e envia sua borda superior para ele
-        agentes_locais.insert(agentes_locais.end(), recv_buffer_cima.begin(), recv_buffer_cima.end());
+    saida->esvaziar();
+    double tempo_total = omp_get_wtime() - inicio_simulacao;
+    Rastro::finalizar();
+    encerrar_linhagem(MPI_COMM_SELF, 0, linhagem, !ensemble);
+
+    if (!ensemble) {
+        std::cout << "Pico da arena de ciclo: " << arena.get_pico_bytes() / 1024 << " KiB por processo ("
+                  << arena.get_ciclos_com_crescimento() << " ciclos com crescimento após o aquecimento)" << std::endl;
+        std::cout << "Simulacao concluida." << std::endl;
     }
-    if (!recv_buffer_baixo.empty()) {
-        // Recebe do vizinho de baixo e envia sua borda inferior para ele
-        agentes_locais.insert(agentes_locais.end(), recv_buffer_baixo.begin(), recv_buffer_baixo.end());
+    reduzir_e_imprimir_tempos(MPI_COMM_SELF, 0, tempo_total, tempos, ensemble);
+}
+
+// Destino dos resultados do kernel de agentes dentro de uma thread OpenMP
+struct SaidaThread {
+    BufferMigracao& envio_cima;
+    BufferMigracao& envio_baixo;
+    std::vector<Agente>& lista_local;
+    IdsThread* ids; // Ids em paralelo a lista_local e dos migrantes (nullptr sem IDS_AGENTES)
+    int mortes;
+    int nascimentos;
+    float energia; // Energia dos agentes que ficam no rank (métrica do ciclo, sem outra passada)
+
+    void trecho(int inicio) { if (Config::IDS_AGENTES) ids->trecho(inicio); }
+    void morte() { mortes++; if (Config::IDS_AGENTES) ids->morte(); }
+    // Migrantes saem em lotes de TAMANHO_LOTE_MIGRACAO assim que o lote da thread enche
+    void migrante(Direcao d, const Agente& a) {
+        IdAgente id = Config::IDS_AGENTES ? ids->migrante(d == Direcao::CIMA) : 0;
+        (d == Direcao::CIMA ? envio_cima : envio_baixo).adicionar(a, id);
+    }
+    void local(const Agente& a) { lista_local.push_back(a); energia += a.get_energia(); if (Config::IDS_AGENTES) ids->local(); }
+    void nascimento(const Agente& filho) {
+        lista_local.push_back(filho); nascimentos++; energia += filho.get_energia();
+        if (Config::IDS_AGENTES) ids->nascimento();
+    }
+};
+
+// Trecho [ini, fim) dos agentes pelo kernel em lote (SIMD) ou pelo caminho escalar de referência:
+// mesmos resultados, mesma ordem (a saída acompanha os ids a partir de `ini`)
+template <typename Saida>
+void rodar_kernel_agentes(const VetorAgentes& agentes, int ini, int fim, Territorio& subgrid, Saida& saida, bool em_lote) {
+    saida.trecho(ini);
+    if (em_lote) {
+        processar_lote_agentes(agentes.data() + ini, fim - ini, subgrid, saida);
+    } else {
+        for (int i = ini; i < fim; ++i) {
+            processar_agente_escalar(agentes[i], subgrid, saida);
+        }
     }
 }
 
-void coletar_e_imprimir_metricas(
-    int rank, int t, Estacao estacao_atual,
-    const std::vector<Agente>& agentes_locais,
+// Agentes e migração de um ciclo numa única região paralela (um fork/join): laço de agentes,
+// conclusão da migração pela thread principal enquanto as demais esperam na barreira e
+// reagrupamento por faixa (construções órfãs). Preenche as métricas de agentes do ciclo
+// (população, energia, migração, mortes e nascimentos) como subproduto: a energia é somada na
+// emissão de cada agente pelo kernel e na chegada dos migrantes.
+// A forma do laço (serial, por faixa, dinâmica; por agente ou em lote) é escolhida a cada ciclo
+// pelo `seletor`, com a população atual e os tempos das threads medidos aqui. Em SERIAL a região
+// fica inativa (`if`): a thread principal faz tudo, inclusive o reagrupamento com uma faixa só.
+// Sem canal (modo de um processo só), a migração se reduz à troca das listas.
+void processar_agentes(
+    VetorAgentes& agentes_locais,
+    IdsLocais& ids_locais,
+    std::vector<int>& inicio_faixa,
     Territorio& subgrid,
-    int local_migracao, float local_consumo, float local_regeneracao,
-    int local_mortes, int local_nascimentos,
-    long long& volume_migracao_total)
+    CanalMigracao* canal,
+    ArenaCiclo& arena,
+    SeletorEstrategia& seletor,
+    TemposFases& tempos,
+    MetricasLocaisCiclo& metricas,
+    int ciclo,
+    LogLinhagem* linhagem)
 {
-    int local_num_agentes = (int)agentes_locais.size();
-    float local_recursos   = subgrid.get_recursos_totais();
+    double marca = omp_get_wtime();
+    double marca_migracao = marca;
+
+    // Os buffers da arena são esvaziados (com capacidade preservada) para o novo ciclo
+    arena.reiniciar();
+    VetorAgentes& nova_lista_local = arena.nova_lista;
 
-    // Calcula a energia total local dos agentes para a métrica de média
-    float local_energia_total = 0.0f;
-    #pragma omp parallel for reduction(+:local_energia_total)
-    for (int i = 0; i < local_num_agentes; ++i) {
-        local_energia_total += agentes_locais[i].get_energia();
+    int total_mortes = 0;
+    int total_nascimentos = 0;
+    float energia_total = 0.0f;
+    int migracao = 0;
+    double tempo_agentes = 0.0;
+
+    int n = (int)agentes_locais.size();
+    EstrategiaAgentes estrategia = seletor.escolher(n);
+    bool em_lote = SeletorEstrategia::em_lote(estrategia);
+    int equipe = seletor.equipe(estrategia);
+    int num_faixas = (int)inicio_faixa.size() - 1;
+    arena.preparar(equipe);
+
+    #pragma omp parallel num_threads(equipe) if(equipe > 1) reduction(+:total_mortes, total_nascimentos, energia_total)
+    {
+        double inicio_thread = omp_get_wtime();
+        ArenaCiclo::BuffersThread& buffers = arena.da_thread(omp_get_thread_num());
+        std::vector<Agente>& lista_local_thread = buffers.lista_local;
+
+        // Ids (array frio): seguem a saída do kernel pela ordem de emissão; com --linhagem, a
+        // thread também anota nascimentos, mortes e migrações
+        IdsThread ids_thread(ids_locais.ids.data(), buffers.ids_local, buffers.bloco_ids, ids_locais.gerador,
+                             linhagem ? &buffers.eventos : nullptr);
+        IdsThread* ids = Config::IDS_AGENTES ? &ids_thread : nullptr;
+
+        // Afinidade espacial: a thread t processa os agentes da sua faixa de linhas (NUMA-local).
+        // Se o runtime entregar outro número de threads (ou o ciclo anterior foi serial, com uma
+        // faixa só), cai para a divisão estática simples.
+        int nt = omp_get_num_threads();
+        int t = omp_get_thread_num();
+        int ini = (nt == num_faixas) ? inicio_faixa[t] : (int)((long long)n * t / nt);
+        int fim = (nt == num_faixas) ? inicio_faixa[t + 1] : (int)((long long)n * (t + 1) / nt);
+
+        // O mesmo trecho de kernel para a faixa inteira ou para cada pedaço dinâmico
+        auto rodar = [&](auto& saida) {
+            if (estrategia == EstrategiaAgentes::DINAMICA) {
+                #pragma omp for schedule(dynamic, 1) nowait
+                for (int p = 0; p < n; p += Config::AGENTES_POR_PEDACO_DINAMICO) {
+                    rodar_kernel_agentes(agentes_locais, p, std::min(n, p + Config::AGENTES_POR_PEDACO_DINAMICO),
+                                         subgrid, saida, em_lote);
+                }
+            } else {
+                rodar_kernel_agentes(agentes_locais, ini, fim, subgrid, saida, em_lote);
+            }
+        };
+
+        if (canal) {
+            // Vetores privados para cada thread (evita contenção no início), reaproveitados da arena.
+            // Os migrantes vão direto para lotes do pool limitado do canal
+            BufferMigracao envio_cima_thread(*canal, Direcao::CIMA);
+            BufferMigracao envio_baixo_thread(*canal, Direcao::BAIXO);
+            SaidaThread saida{envio_cima_thread, envio_baixo_thread, lista_local_thread, ids, 0, 0, 0.0f};
+            rodar(saida);
+            total_mortes += saida.mortes;
+            total_nascimentos += saida.nascimentos;
+            energia_total += saida.energia;
+
+            // Lotes parciais restantes seguem pelo canal
+            envio_cima_thread.descarregar();
+            envio_baixo_thread.descarregar();
+        } else {
+            SaidaGradeInteira saida{lista_local_thread, ids, 0, 0, 0.0f};
+            rodar(saida);
+            total_mortes += saida.mortes;
+            total_nascimentos += saida.nascimentos;
+            energia_total += saida.energia;
+        }
+        double fim_thread = omp_get_wtime();
+        seletor.registrar_thread(t, fim_thread - inicio_thread);
+        Rastro::registrar("agentes_thread", inicio_thread, fim_thread);
+
+        // Consolidação segura (Região Crítica)
+        #pragma omp critical
+        {
+            nova_lista_local.insert(nova_lista_local.end(), lista_local_thread.begin(), lista_local_thread.end());
+            if (Config::IDS_AGENTES) arena.novos_ids.insert(arena.novos_ids.end(), buffers.ids_local.begin(), buffers.ids_local.end());
+            if (linhagem) arena.eventos_ciclo.insert(arena.eventos_ciclo.end(), buffers.eventos.begin(), buffers.eventos.end());
+        }
+
+        // Migração: só a thread principal fala com o canal (sem a thread de comunicação, é ela quem
+        // progride o MPI em finalizar_ciclo; com ela, só espera o ciclo do canal concluir)
+        #pragma omp barrier
+        #pragma omp master
+        {
+            tempo_agentes = Rastro::fechar_fase("agentes", marca);
+            tempos.agentes += tempo_agentes;
+            marca_migracao = omp_get_wtime();
+
+            // Os lotes já foram entregues ao canal durante o laço de agentes (e, com a thread de
+            // comunicação ativa, boa parte já foi enviada e recebida). Aqui só resta enviar os
+            // marcadores de fim, aguardar os dos vizinhos e consolidar. A troca (em vez de mover)
+            // devolve à arena o buffer da lista antiga, com sua capacidade, para o próximo ciclo.
+            agentes_locais.swap(nova_lista_local);
+            ids_locais.ids.swap(arena.novos_ids);
+            if (canal) {
+                size_t locais = agentes_locais.size();
+                canal->finalizar_ciclo(agentes_locais, ids_locais.ids);
+                migracao = canal->get_enviados_ciclo();
+                for (size_t i = locais; i < agentes_locais.size(); ++i) energia_total += agentes_locais[i].get_energia();
+            }
+            if (linhagem) linhagem->registrar(ciclo, arena.eventos_ciclo);
+        }
+        #pragma omp barrier
+
+        agrupar_agentes_por_faixa_na_regiao(agentes_locais, arena.auxiliar_faixas, arena.cursor_faixas, inicio_faixa, subgrid,
+                                            ids_locais.vetor(), &arena.auxiliar_ids);
     }
 
+    arena.registrar_ciclo(agentes_locais, ids_locais.vetor());
+    tempos.migracao += Rastro::fechar_fase("migracao", marca_migracao);
+    seletor.concluir(estrategia, n, equipe);
+
+    metricas.num_agentes = (int)agentes_locais.size();
+    metricas.migracao = migracao;
+    metricas.mortes = total_mortes;
+    metricas.nascimentos = total_nascimentos;
+    metricas.energia_total = energia_total;
+    metricas.estrategia_agentes = (int)estrategia;
+    metricas.tempo_agentes = (float)tempo_agentes;
+}
+
+void reduzir_e_imprimir_metricas(
+    MPI_Comm comm, int rank, const Parametros& parametros, int t_inicial,
+    const Estacao* estacoes,
+    const MetricasLocaisCiclo* metricas,
+    int num_ciclos,
+    long long& volume_migracao_total,
+    SaidaMetricas* saida,
+    BuffersReducaoMetricas& buffers)
+{
     // ── Otimização MPI: substituição de 10 Reduce individuais por chamadas agrupadas ──
     //
-    // Array com os 8 escalares cujo resultado final é uma SOMA entre processos.
+    // Por ciclo, 8 escalares cujo resultado final é uma SOMA entre processos.
     // Índices:
     //   [0] num_agentes   [1] recursos      [2] consumo
     //   [3] regeneracao   [4] migracao      [5] mortes   [6] nascimentos
     //   [7] energia_total
-    float buf_local[8] = {
-        (float)local_num_agentes,
-        local_recursos,
-        local_consumo,
-        local_regeneracao,
-        (float)local_migracao,
-        (float)local_mortes,
-        (float)local_nascimentos,
-        local_energia_total
-    };
-    float buf_global[8] = {};
+    // Com blocagem temporal, os `num_ciclos` ciclos do bloco vão numa única redução.
+    float* buf_local = buffers.somas_local.data();
+    float* buf_global = buffers.somas_global.data();
+    int* extremos_local = buffers.extremos_local.data();
+    int* extremos_global = buffers.extremos_global.data();
+    for (int c = 0; c < num_ciclos; ++c) {
+        const MetricasLocaisCiclo& m = metricas[c];
+        float* b = &buf_local[8 * c];
+        b[0] = (float)m.num_agentes;
+        b[1] = m.recursos;
+        b[2] = m.consumo;
+        b[3] = m.regeneracao;
+        b[4] = (float)m.migracao;
+        b[5] = (float)m.mortes;
+        b[6] = (float)m.nascimentos;
+        b[7] = m.energia_total;
+
+        // MAX e MIN de agentes por processo numa só redução MAX: min(n) = -max(-n); junto, o
+        // laço de agentes mais lento (em µs)
+        extremos_local[3 * c] = m.num_agentes;
+        extremos_local[3 * c + 1] = -m.num_agentes;
+        extremos_local[3 * c + 2] = (int)(m.tempo_agentes * 1e6f);
+    }
 
     // 1ª chamada: MPI_Allreduce (SUM) para todos os valores de soma.
     // Todos os processos recebem o resultado (necessário para global_num_agentes).
-    MPI_Allreduce(buf_local, buf_global, 8, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
-
-    int global_num_agentes    = (int)buf_global[0];
-    float global_recursos     = buf_global[1];
-    float global_consumo      = buf_global[2];
-    float global_regeneracao  = buf_global[3];
-    int global_migracao_ciclo = (int)buf_global[4];
-    int global_mortes         = (int)buf_global[5];
-    int global_nascimentos    = (int)buf_global[6];
-    float global_energia_total = buf_global[7];
-
-    // 2ª e 3ª chamadas: MAX e MIN de agentes por processo (não podem ser combinados
-    // com SUM nem entre si em um único MPI_Reduce sem uma struct customizada).
-    int global_max_agentes = 0;
-    int global_min_agentes = 0;
-    MPI_Reduce(&local_num_agentes, &global_max_agentes, 1, MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
-    MPI_Reduce(&local_num_agentes, &global_min_agentes, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
-
-    if (rank == 0) {
-        volume_migracao_total += global_migracao_ciclo;
-        float recursos_medios = global_recursos / (Config::LARGURA_GRID * Config::ALTURA_GRID);
-        bool sustentavel = global_regeneracao >= global_consumo;
-
-        std::cout << "\033[1;36m" << "┌" << std::string(60, '-') << "┐\033[0m" << std::endl;
-        std::cout << "\033[1;36m| CICLO " << std::setw(4) << t << " ["
-                  << (estacao_atual == Estacao::SECA ? "\033[1;33mSECA" : "\033[1;34mCHEIA") << "\033[1;36m]"
-                  << std::setw(34) << " |" << "\033[0m" << std::endl;
-        std::cout << "\033[1;36m" << "├" << std::string(60, '-') << "┤\033[0m" << std::endl;
-
-        float energia_media = (global_num_agentes > 0) ? (global_energia_total / global_num_agentes) : 0.0f;
-        std::cout << "  Agentes Totais: " << std::setw(6) << global_num_agentes
-                  << " | Energia Média: " << std::fixed << std::setprecision(2) << energia_media << std::endl;
-        std::cout << "  Distribuição:   Min/Max por Proc: " << std::setw(4) << global_min_agentes << " / " << std::setw(4) << global_max_agentes << std::endl;
-
-        std::cout << "  Dinâmica:       " << "\033[1;32m+" << std::setw(3) << global_nascimentos << "\033[0m nascimentos, "
-                  << "\033[1;31m-" << std::setw(3) << global_mortes << "\033[0m mortes" << std::endl;
-
-        std::cout << "  Migração:       " << std::setw(5) << global_migracao_ciclo << " (Ciclo) | "
-                  << std::setw(8) << volume_migracao_total << " (Acumulada)" << std::endl;
-
-        std::cout << "  Recursos:       " << std::fixed << std::setprecision(1) << std::setw(8) << global_recursos
-                  << " (Total) | " << std::setprecision(2) << recursos_medios << " (Méd/Cel)" << std::endl;
-
-        std::cout << "  Sustentabilidade: "
-                  << (sustentavel ? "\033[1;32m[POSITIVA]\033[0m" : "\033[1;31m[NEGATIVA]\033[0m")
-                  << " (Reg: " << std::fixed << std::setprecision(1) << global_regeneracao
-                  << " vs Cons: " << global_consumo << ")" << std::endl;
-
-        std::cout << "\033[1;36m" << "└" << std::string(60, '-') << "┘\033[0m" << std::endl;
-    }
-}
\ No newline at end of file
+    MPI_Allreduce(buf_local, buf_global, 8 * num_ciclos, MPI_FLOAT, MPI_SUM, comm);
+
+    // 2ª chamada: MAX (e MIN, pelo negativo) de agentes por processo
+    MPI_Reduce(extremos_local, extremos_global, 3 * num_ciclos, MPI_INT, MPI_MAX, 0, comm);
+
+    // Ciclos emitidos: a cada intervalo_metricas e sempre o último. Os demais só entram na
+    // migração acumulada.
+    auto emitido = [&](int t) {
+        return t % parametros.intervalo_metricas == 0 || t == parametros.total_ciclos - 1;
+    };
+    bool algum_emitido = false;
+    for (int c = 0; c < num_ciclos; ++c) algum_emitido = algum_emitido || emitido(t_inicial + c);
+
+    // Detalhamento por processo: os mesmos 8 escalares de cada rank, mais a estratégia e o tempo
+    // do laço de agentes, juntados no rank 0 (só quando o bloco tem ciclo emitido; a condição é a
+    // mesma em todos os ranks)
+    constexpr int POR_RANK = BuffersReducaoMetricas::POR_RANK;
+    int num_processos = 1;
+    MPI_Comm_size(comm, &num_processos);
+    int ranks_juntados = 0;
+    if (parametros.metricas_por_rank && algum_emitido) {
+        float* buf_rank_local = buffers.rank_local.data();
+        for (int c = 0; c < num_ciclos; ++c) {
+            std::copy(&buf_local[8 * c], &buf_local[8 * c] + 8, &buf_rank_local[POR_RANK * c]);
+            buf_rank_local[POR_RANK * c + 8] = (float)metricas[c].estrategia_agentes;
+            buf_rank_local[POR_RANK * c + 9] = metricas[c].tempo_agentes;
+        }
+        MPI_Gather(buf_rank_local, POR_RANK * num_ciclos, MPI_FLOAT, buffers.ranks.data(), POR_RANK * num_ciclos,
+                   MPI_FLOAT, 0, comm);
+        ranks_juntados = num_processos;
+    }
+
+    if (rank != 0) return;
+
+    for (int c = 0; c < num_ciclos; ++c) {
+        const float* g = &buf_global[8 * c];
+        int t = t_inicial + c;
+        volume_migracao_total += (int)g[4];
+        if (!emitido(t)) continue;
+
+        RegistroMetricas registro;
+        registro.cenario = 0;
+        registro.ciclo = t;
+        registro.estacao = (int)estacoes[c];
+        registro.rank = -1;
+        registro.agentes = (int)g[0];
+        registro.min_agentes = -extremos_global[3 * c + 1];
+        registro.max_agentes = extremos_global[3 * c];
+        registro.nascimentos = (int)g[6];
+        registro.mortes = (int)g[5];
+        registro.migracao = (int)g[4];
+        registro.migracao_acumulada = volume_migracao_total;
+        registro.recursos = g[1];
+        registro.consumo = g[2];
+        registro.regeneracao = g[3];
+        registro.energia_total = g[7];
+        registro.estrategia_agentes = -1;
+        registro.tempo_agentes = extremos_global[3 * c + 2] * 1e-6f;
+        saida->registrar(registro);
+
+        for (int r = 0; r < ranks_juntados; ++r) {
+            const float* l = &buffers.ranks[(size_t)POR_RANK * (r * num_ciclos + c)];
+            registro.rank = r;
+            registro.agentes = (int)l[0];
+            registro.min_agentes = registro.max_agentes = registro.agentes;
+            registro.nascimentos = (int)l[6];
+            registro.mortes = (int)l[5];
+            registro.migracao = (int)l[4];
+            registro.migracao_acumulada = 0;
+            registro.recursos = l[1];
+            registro.consumo = l[2];
+            registro.regeneracao = l[3];
+            registro.energia_total = l[7];
+            registro.estrategia_agentes = (int)l[8];
+            registro.tempo_agentes = l[9];
+            saida->registrar(registro);
+        }
+    }
+}
+
+// Relatório de desempenho: tempo total e por fase do rank mais lento (caminho crítico), em
+// linhas CHAVE=valor fáceis de extrair por script (run.sh)
+// (no ensemble, os tempos de cada cenário saem no fluxo combinado)
+void reduzir_e_imprimir_tempos(MPI_Comm comm, int rank, double tempo_total, const TemposFases& tempos, Ensemble* ensemble) {
+    double local[NUM_TEMPOS] = {tempo_total, tempos.halo, tempos.agentes, tempos.migracao, tempos.recursos, tempos.metricas,
+                                tempos.inicializacao};
+    double global[NUM_TEMPOS] = {};
+    MPI_Reduce(local, global, NUM_TEMPOS, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    if (rank != 0) return;
+    if (ensemble) {
+        ensemble->registrar_tempos(global);
+        return;
+    }
+    std::cout << std::fixed << std::setprecision(6);
+    for (int i = 0; i < NUM_TEMPOS; ++i) {
+        std::cout << CHAVES_TEMPOS[i] << "_SECONDS=" << global[i] << std::endl;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef METRICAS_HPP
+#define METRICAS_HPP
+
+#include <array>
+#include <vector>
+#include "agente.hpp"
+#include "config.hpp"
+#include "territorio.hpp"
+
+// Métricas locais (deste rank) de um ciclo, antes da redução entre processos.
+// Ficam separadas da impressão para que vários ciclos possam ser reduzidos de uma vez
+// (blocagem temporal: uma sincronização a cada PROFUNDIDADE_BLOCO_TEMPORAL ciclos).
+// São preenchidas como subproduto dos kernels, sem passadas próprias: população, energia,
+// migração, mortes e nascimentos pelo laço de agentes; consumo e recursos pela varredura de
+// atualização do grid (Territorio::atualizar_recursos_com_balanco).
+struct MetricasLocaisCiclo {
+    int num_agentes;
+    float recursos;
+    float consumo;
+    float regeneracao;
+    int migracao;
+    int mortes;
+    int nascimentos;
+    float energia_total;
+    int estrategia_agentes; // EstrategiaAgentes do laço de agentes do ciclo
+    float tempo_agentes;    // Tempo de parede (s) do laço de agentes do ciclo
+};
+
+// Buffers da redução das métricas (reduzir_e_imprimir_metricas), criados antes do laço de ciclos e
+// reaproveitados: uma redução cobre no máximo PROFUNDIDADE_BLOCO_TEMPORAL ciclos, então o ciclo não
+// aloca nada no heap para reduzir as métricas
+struct BuffersReducaoMetricas {
+    static constexpr int MAX_CICLOS = Config::PROFUNDIDADE_BLOCO_TEMPORAL;
+    static constexpr int SOMAS = 8;     // Escalares somados entre processos, por ciclo
+    static constexpr int EXTREMOS = 3;  // Máximo e mínimo de agentes e laço mais lento, por ciclo
+    static constexpr int POR_RANK = 10; // Valores de cada processo com --metricas-por-rank, por ciclo
+
+    std::array<float, SOMAS * MAX_CICLOS> somas_local;
+    std::array<float, SOMAS * MAX_CICLOS> somas_global;
+    std::array<int, EXTREMOS * MAX_CICLOS> extremos_local;
+    std::array<int, EXTREMOS * MAX_CICLOS> extremos_global;
+    std::array<float, POR_RANK * MAX_CICLOS> rank_local;
+    std::vector<float> ranks; // Só no rank 0 com --metricas-por-rank: espaço para todos os processos
+
+    BuffersReducaoMetricas(int rank, int num_processos, bool metricas_por_rank) {
+        if (rank == 0 && metricas_por_rank) ranks.resize((size_t)POR_RANK * MAX_CICLOS * num_processos);
+    }
+};
+
+// Tempo de parede (s) acumulado em cada fase do ciclo por um rank, para o relatório de desempenho
+// (linhas CHAVE=valor no fim da execução, lidas pelo run.sh)
+struct TemposFases {
+    double halo = 0.0;      // Troca de halos (ou sincronização do bloco temporal)
+    double agentes = 0.0;   // Laço de agentes
+    double migracao = 0.0;  // Conclusão da migração e reagrupamento dos agentes
+    double recursos = 0.0;  // Consumo/regeneração e atualização do subgrid
+    double metricas = 0.0;  // Redução e impressão das métricas, mais a barreira do ciclo
+    double inicializacao = 0.0; // Criação da população inicial (antes dos ciclos, fora do TOTAL)
+};
+
+// Chaves do relatório de tempos (CHAVE_SECONDS=valor), na ordem em que os tempos são reduzidos:
+// o total da simulação e depois os campos de TemposFases
+constexpr int NUM_TEMPOS = 7;
+constexpr const char* CHAVES_TEMPOS[NUM_TEMPOS] = {"TOTAL", "HALO", "AGENTES", "MIGRACAO", "RECURSOS", "METRICAS", "INICIALIZACAO"};
+
+#endif // METRICAS_HPP
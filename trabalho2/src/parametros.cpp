@@ -0,0 +1,83 @@
+#include "parametros.hpp"
+#include <cstdlib>
+#include <cstring>
+
+bool ler_parametros(int argc, char** argv, Parametros& parametros, std::string& erro) {
+    struct Opcao {
+        const char* nome;
+        int* destino;
+    };
+    const Opcao opcoes[] = {
+        {"--largura", &parametros.largura_grid},
+        {"--altura", &parametros.altura_grid},
+        {"--agentes", &parametros.num_agentes},
+        {"--ciclos", &parametros.total_ciclos},
+        {"--intervalo-metricas", &parametros.intervalo_metricas},
+    };
+
+    struct OpcaoTexto {
+        const char* nome;
+        std::string* destino;
+    };
+    const OpcaoTexto opcoes_texto[] = {
+        {"--densidade", &parametros.densidade},
+        {"--cenarios", &parametros.cenarios},
+        {"--metricas", &parametros.metricas},
+        {"--linhagem", &parametros.linhagem},
+    };
+
+    struct OpcaoBooleana {
+        const char* nome;
+        bool* destino;
+    };
+    const OpcaoBooleana opcoes_booleanas[] = {
+        {"--metricas-por-rank", &parametros.metricas_por_rank},
+        {"--servico", &parametros.servico},
+    };
+
+    for (int i = 1; i < argc; ++i) {
+        const OpcaoBooleana* opcao_booleana = nullptr;
+        for (const OpcaoBooleana& o : opcoes_booleanas) {
+            if (std::strcmp(argv[i], o.nome) == 0) opcao_booleana = &o;
+        }
+        if (opcao_booleana != nullptr) {
+            *opcao_booleana->destino = true;
+            continue;
+        }
+
+        const OpcaoTexto* opcao_texto = nullptr;
+        for (const OpcaoTexto& o : opcoes_texto) {
+            if (std::strcmp(argv[i], o.nome) == 0) opcao_texto = &o;
+        }
+        if (opcao_texto != nullptr) {
+            if (i + 1 >= argc) {
+                erro = std::string("valor ausente para ") + opcao_texto->nome;
+                return false;
+            }
+            *opcao_texto->destino = argv[++i];
+            continue;
+        }
+
+        const Opcao* opcao = nullptr;
+        for (const Opcao& o : opcoes) {
+            if (std::strcmp(argv[i], o.nome) == 0) opcao = &o;
+        }
+        if (opcao == nullptr) {
+            erro = std::string("opção desconhecida: ") + argv[i];
+            return false;
+        }
+        if (i + 1 >= argc) {
+            erro = std::string("valor ausente para ") + opcao->nome;
+            return false;
+        }
+
+        char* fim = nullptr;
+        long valor = std::strtol(argv[++i], &fim, 10);
+        if (*fim != '\0' || valor <= 0 || valor > 1000000000L) {
+            erro = std::string("valor inválido para ") + opcao->nome + ": " + argv[i];
+            return false;
+        }
+        *opcao->destino = (int)valor;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef PARAMETROS_HPP
+#define PARAMETROS_HPP
+
+#include <string>
+#include "config.hpp"
+
+// Parâmetros do tamanho do problema que podem ser trocados pela linha de comando, para varrer
+// tamanhos de grid e de população (benchmarks de escalabilidade) sem recompilar.
+// Sem argumentos, valem os padrões de config.hpp.
+//
+//     trabalho2 [--largura L] [--altura A] [--agentes N] [--ciclos C] [--densidade uniforme|tipos|<mapa>]
+//               [--cenarios <arquivo>] [--metricas console|csv|jsonl[:<arquivo>]] [--intervalo-metricas K]
+//               [--metricas-por-rank] [--servico] [--linhagem <arquivo>]
+struct Parametros {
+    int largura_grid = Config::LARGURA_GRID;
+    int altura_grid = Config::ALTURA_GRID;
+    int num_agentes = Config::N_AGENTS;
+    int total_ciclos = Config::TOTAL_CICLOS;
+    std::string densidade = "uniforme"; // Perfil da população inicial (PerfilDensidade)
+    std::string cenarios;                // Arquivo de cenários do ensemble (vazio: só o cenário padrão)
+    std::string metricas;                // Destino das métricas (vazio: console, ou csv no ensemble)
+    int intervalo_metricas = 1;          // Emite as métricas a cada K ciclos (e sempre no último)
+    bool metricas_por_rank = false;      // Emite também os valores locais de cada processo
+    bool servico = false;                // Modo serviço: ciclos sob comando (servico.hpp) em vez de total_ciclos
+    std::string linhagem;                // Prefixo dos arquivos do log de linhagem (linhagem.hpp; vazio: sem log)
+};
+
+// Lê os argumentos sobre os padrões. Retorna false e descreve o problema em `erro` se houver
+// opção desconhecida, valor ausente ou não positivo (o perfil de densidade, os cenários e o destino das métricas só são validados ao carregar).
+bool ler_parametros(int argc, char** argv, Parametros& parametros, std::string& erro);
+
+#endif // PARAMETROS_HPP
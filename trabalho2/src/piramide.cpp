@@ -0,0 +1,126 @@
+#include "piramide.hpp"
+#include <algorithm>
+
+PiramideRecursos::PiramideRecursos(int largura_grid, int altura_grid, int y_ini, int altura_local, int num_niveis)
+    : largura_grid(largura_grid), altura_grid(altura_grid), y_ini(y_ini), y_fim(y_ini + altura_local) {
+    size_t floats_borda = 0;
+    for (int l = 1; l <= num_niveis; ++l) {
+        Nivel n;
+        n.expoente = l;
+        n.lado = 1 << l;
+        n.largura = (largura_grid + n.lado - 1) >> l;
+        n.linhas_grid = (altura_grid + n.lado - 1) >> l;
+        n.passo = n.largura + 2;
+        n.t0 = y_ini >> l;
+        n.linhas = ((y_fim - 1) >> l) - n.t0 + 3;
+        n.soma.assign((size_t)n.linhas * n.passo, 0.0);
+        n.media.assign((size_t)n.linhas * n.passo, Territorio::RECURSO_FANTASMA);
+        niveis.push_back(std::move(n));
+        floats_borda += 2 * (size_t)(largura_grid + 2); // Limite folgado: duas linhas por nível
+    }
+    for (int d = 0; d < 2; ++d) {
+        envio[d].resize(floats_borda);
+        recepcao[d].resize(floats_borda);
+    }
+}
+
+void PiramideRecursos::atualizar(const Territorio& grid, MPI_Comm comm, int rank, int size) {
+    somar_celulas(grid);
+    trocar_bordas(comm, rank, size);
+    calcular_medias();
+}
+
+void PiramideRecursos::somar_celulas(const Territorio& grid) {
+    // Nível 1 a partir das células próprias: cada linha de ladrilhos soma as (até duas) linhas de
+    // células que o rank tem dela. As linhas guardadas sem células próprias ficam zeradas.
+    Nivel& primeiro = niveis[0];
+    std::fill(primeiro.soma.begin(), primeiro.soma.end(), 0.0);
+    int t1 = (y_fim - 1) >> 1;
+    #pragma omp parallel for schedule(static)
+    for (int t = primeiro.t0; t <= t1; ++t) {
+        double* linha_soma = &primeiro.soma[(size_t)linha_local(primeiro, t) * primeiro.passo + 1];
+        int gy_ini = std::max(t << 1, y_ini);
+        int gy_fim = std::min((t + 1) << 1, y_fim);
+        for (int gy = gy_ini; gy < gy_fim; ++gy) {
+            const float* recurso = grid.ptr_recurso(Posicao(0, gy - y_ini));
+            for (int x = 0; x < largura_grid; ++x) linha_soma[x >> 1] += recurso[x];
+        }
+    }
+
+    // Níveis seguintes: cada ladrilho soma os seus 2x2 filhos (as linhas filhas fora das células
+    // próprias são zero, então o resultado continua sendo a soma parcial deste rank)
+    for (size_t k = 1; k < niveis.size(); ++k) {
+        const Nivel& filho = niveis[k - 1];
+        Nivel& n = niveis[k];
+        std::fill(n.soma.begin(), n.soma.end(), 0.0);
+        int t1_nivel = (y_fim - 1) >> n.expoente;
+        #pragma omp parallel for schedule(static)
+        for (int t = n.t0; t <= t1_nivel; ++t) {
+            double* linha_soma = &n.soma[(size_t)linha_local(n, t) * n.passo + 1];
+            for (int tf = 2 * t; tf <= 2 * t + 1; ++tf) {
+                const double* linha_filha = &filho.soma[(size_t)linha_local(filho, tf) * filho.passo + 1];
+                for (int x = 0; x < filho.largura; ++x) linha_soma[x >> 1] += linha_filha[x];
+            }
+        }
+    }
+}
+
+void PiramideRecursos::trocar_bordas(MPI_Comm comm, int rank, int size) {
+    if (size == 1) return;
+
+    // Para cima vão as somas parciais das duas últimas linhas de ladrilhos do vizinho de cima
+    // ((y_ini - 1) >> l e a seguinte); de baixo chegam as das nossas duas últimas (t1 e t1 + 1).
+    // Simétrico para baixo. Todos os níveis em sequência na mesma mensagem.
+    auto linhas_de = [&](int d, const Nivel& n) {
+        return d == 0 ? ((y_ini - 1) >> n.expoente) : (y_fim >> n.expoente) - 1;
+    };
+    auto linhas_para = [&](int d, const Nivel& n) {
+        return d == 0 ? n.t0 - 1 : ((y_fim - 1) >> n.expoente);
+    };
+    const int vizinho[2] = {rank - 1, rank + 1};
+
+    MPI_Request reqs[4];
+    int num_reqs = 0;
+    int tamanho = 0;
+    for (const Nivel& n : niveis) tamanho += 2 * n.passo;
+    for (int d = 0; d < 2; ++d) {
+        if (vizinho[d] < 0 || vizinho[d] >= size) continue;
+        double* destino = envio[d].data();
+        for (const Nivel& n : niveis) {
+            const double* origem = &n.soma[(size_t)linha_local(n, linhas_de(d, n)) * n.passo];
+            destino = std::copy(origem, origem + 2 * n.passo, destino);
+        }
+        MPI_Irecv(recepcao[d].data(), tamanho, MPI_DOUBLE, vizinho[d], TAG_PIRAMIDE, comm, &reqs[num_reqs++]);
+        MPI_Isend(envio[d].data(), tamanho, MPI_DOUBLE, vizinho[d], TAG_PIRAMIDE, comm, &reqs[num_reqs++]);
+    }
+    MPI_Waitall(num_reqs, reqs, MPI_STATUSES_IGNORE);
+
+    for (int d = 0; d < 2; ++d) {
+        if (vizinho[d] < 0 || vizinho[d] >= size) continue;
+        const double* origem = recepcao[d].data();
+        for (Nivel& n : niveis) {
+            double* linhas = &n.soma[(size_t)linha_local(n, linhas_para(d, n)) * n.passo];
+            for (int i = 0; i < 2 * n.passo; ++i) linhas[i] += origem[i];
+            origem += 2 * n.passo;
+        }
+    }
+}
+
+void PiramideRecursos::calcular_medias() {
+    for (Nivel& n : niveis) {
+        #pragma omp parallel for schedule(static)
+        for (int linha = 0; linha < n.linhas; ++linha) {
+            int t = n.t0 - 1 + linha;
+            float* media = &n.media[(size_t)linha * n.passo + 1];
+            const double* soma = &n.soma[(size_t)linha * n.passo + 1];
+            if (t < 0 || t >= n.linhas_grid) continue; // Fora do grid: fica RECURSO_FANTASMA
+
+            // Ladrilhos da borda direita/inferior do grid são parciais
+            int celulas_y = std::min((t + 1) << n.expoente, altura_grid) - (t << n.expoente);
+            for (int x = 0; x < n.largura; ++x) {
+                int celulas_x = std::min((x + 1) << n.expoente, largura_grid) - (x << n.expoente);
+                media[x] = (float)(soma[x] / (celulas_x * celulas_y));
+            }
+        }
+    }
+}
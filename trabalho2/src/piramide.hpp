@@ -0,0 +1,87 @@
+#ifndef PIRAMIDE_HPP
+#define PIRAMIDE_HPP
+
+#include <mpi.h>
+#include <vector>
+#include "territorio.hpp"
+#include "config.hpp"
+
+// Pirâmide multirresolução do recurso (mip-map de médias) para a percepção estendida dos
+// agentes. O nível l (1..num_niveis) divide o grid GLOBAL em ladrilhos de 2^l x 2^l células
+// alinhados à origem e guarda a média do recurso de cada ladrilho. Um agente com fome
+// (PERCEPCAO_ESTENDIDA) compara o seu ladrilho com os 8 vizinhos em cada nível, do mais fino ao
+// mais grosso, e segue na direção do primeiro ladrilho vizinho mais rico: enxerga ~2^L células
+// com 8 leituras por nível, O(log R) em vez de varrer um raio R inteiro.
+//
+// Cada rank guarda, por nível, as linhas de ladrilhos com células suas e uma linha a mais de
+// cada lado (os ladrilhos vizinhos dos seus agentes), com colunas fantasmas nas bordas. Os
+// ladrilhos que cruzam a fronteira entre faixas somam células de dois ranks: depois de somar as
+// próprias células, cada rank troca com os vizinhos imediatos as somas parciais das duas linhas de
+// ladrilhos de cada lado (todos os níveis numa só mensagem por vizinho). Para que ninguém além do
+// vizinho imediato contribua, a faixa de cada rank precisa ter pelo menos altura_minima() linhas.
+// Ladrilhos fora do grid global valem RECURSO_FANTASMA e nunca são escolhidos.
+class PiramideRecursos {
+private:
+    struct Nivel {
+        int expoente;             // l
+        int lado;                 // Células por lado do ladrilho (2^l)
+        int largura;              // Ladrilhos por linha do grid global (o último pode ser parcial)
+        int linhas_grid;          // Linhas de ladrilhos do grid global
+        int passo;                // largura + 2 (colunas fantasmas -1 e largura)
+        int t0;                   // Primeira linha de ladrilhos com células deste rank (a guardada começa em t0 - 1)
+        int linhas;               // Linhas guardadas: t1 - t0 + 3
+        std::vector<double> soma; // Somas (parciais até a troca com os vizinhos)
+        std::vector<float> media;
+    };
+
+    int largura_grid;
+    int altura_grid;
+    int y_ini;                    // Linhas globais próprias [y_ini, y_fim)
+    int y_fim;
+    std::vector<Nivel> niveis;
+    std::vector<double> envio[2];     // [0]: para cima, [1]: para baixo
+    std::vector<double> recepcao[2];
+
+    static constexpr int TAG_PIRAMIDE = 20;
+
+    // Linha guardada da linha de ladrilhos global `t` (t0 - 1 -> 0)
+    static int linha_local(const Nivel& n, int t) { return t - n.t0 + 1; }
+
+    void somar_celulas(const Territorio& grid);
+    void trocar_bordas(MPI_Comm comm, int rank, int size);
+    void calcular_medias();
+
+public:
+    PiramideRecursos(int largura_grid, int altura_grid, int y_ini, int altura_local, int num_niveis = Config::NIVEIS_PIRAMIDE);
+
+    // Menor faixa por rank com que a troca entre vizinhos imediatos basta (dois ladrilhos do nível mais grosso)
+    static int altura_minima(int num_niveis = Config::NIVEIS_PIRAMIDE) { return 2 << num_niveis; }
+
+    // Coletiva com os vizinhos em `comm`: reconstrói a pirâmide a partir do plano de recurso
+    // corrente de `grid` (depois de cada atualização de recursos). O nível 1 vem das células e
+    // cada nível seguinte dos 2x2 ladrilhos do anterior, em paralelo por linha de ladrilhos.
+    void atualizar(const Territorio& grid, MPI_Comm comm, int rank, int size);
+
+    int get_num_niveis() const { return (int)niveis.size(); }
+
+    // Vizinho i (VIZINHO_DX/DY) na direção do ladrilho vizinho mais rico que o da célula global
+    // (gx, gy), no nível mais fino em que houver um (empate: o primeiro na ordem), ou -1.
+    // A célula precisa ser própria deste rank.
+    int direcao(int gx, int gy) const {
+        for (const Nivel& n : niveis) {
+            const float* centro = &n.media[(size_t)linha_local(n, gy >> n.expoente) * n.passo + (gx >> n.expoente) + 1];
+            float melhor = *centro;
+            int escolhido = -1;
+            for (int i = 0; i < 8; ++i) {
+                float candidato = centro[TabelasTerritorio::VIZINHO_DY[i] * n.passo + TabelasTerritorio::VIZINHO_DX[i]];
+                bool melhora = candidato > melhor;
+                melhor = melhora ? candidato : melhor;
+                escolhido = melhora ? i : escolhido;
+            }
+            if (escolhido >= 0) return escolhido;
+        }
+        return -1;
+    }
+};
+
+#endif // PIRAMIDE_HPP
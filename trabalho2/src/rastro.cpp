@@ -0,0 +1,61 @@
+#include "rastro.hpp"
+
+#ifdef RASTREAR
+
+#include <omp.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Evento {
+        const char* fase;
+        double inicio;
+        double fim;
+    };
+
+    // Um vetor por thread OpenMP: o registro dentro de regiões paralelas não precisa de trava
+    struct alignas(64) EventosThread {
+        std::vector<Evento> eventos;
+    };
+
+    int rank_rastro = 0;
+    double origem = 0.0;
+    std::vector<EventosThread> por_thread;
+}
+
+namespace Rastro {
+    void iniciar(int rank) {
+        rank_rastro = rank;
+        origem = omp_get_wtime();
+        por_thread.assign(omp_get_max_threads(), EventosThread{});
+    }
+
+    void registrar(const char* fase, double inicio, double fim) {
+        int t = omp_get_thread_num();
+        if (t < (int)por_thread.size()) por_thread[t].eventos.push_back(Evento{fase, inicio, fim});
+    }
+
+    void finalizar() {
+        std::string nome = "rastro_rank" + std::to_string(rank_rastro) + ".json";
+        std::FILE* arquivo = std::fopen(nome.c_str(), "w");
+        if (!arquivo) return;
+
+        // Eventos completos ("X") em microssegundos desde iniciar()
+        std::fprintf(arquivo, "{\"traceEvents\":[\n");
+        bool primeiro = true;
+        for (int t = 0; t < (int)por_thread.size(); ++t) {
+            for (const Evento& e : por_thread[t].eventos) {
+                std::fprintf(arquivo, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                             primeiro ? "" : ",\n", e.fase, rank_rastro, t,
+                             (e.inicio - origem) * 1e6, (e.fim - e.inicio) * 1e6);
+                primeiro = false;
+            }
+        }
+        std::fprintf(arquivo, "\n],\"displayTimeUnit\":\"ms\"}\n");
+        std::fclose(arquivo);
+        por_thread.clear();
+    }
+}
+
+#endif // RASTREAR
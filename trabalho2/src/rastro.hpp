@@ -0,0 +1,36 @@
+#ifndef RASTRO_HPP
+#define RASTRO_HPP
+
+#include <omp.h>
+
+// Rastro de execução do build instrumentado (make trace, que define RASTREAR).
+//
+// Cada rank grava as fases de cada ciclo (e o trecho de agentes de cada thread OpenMP) em
+// rastro_rank<R>.json, no formato Trace Event do Chrome: abre em chrome://tracing ou no
+// Perfetto, com um processo por rank e uma linha por thread, e mostra desbalanceamento e
+// esperas que o total por fase (TemposFases) esconde. Sem RASTREAR, tudo vira no-op inline.
+namespace Rastro {
+#ifdef RASTREAR
+    // Zera o rastro e marca a origem do tempo (chamar fora de região paralela)
+    void iniciar(int rank);
+    // Registra o intervalo [inicio, fim] (tempos de omp_get_wtime) na linha da thread OpenMP atual
+    void registrar(const char* fase, double inicio, double fim);
+    // Grava rastro_rank<R>.json no diretório atual
+    void finalizar();
+#else
+    inline void iniciar(int) {}
+    inline void registrar(const char*, double, double) {}
+    inline void finalizar() {}
+#endif
+
+    // Encerra a fase aberta em `marca` (de omp_get_wtime): registra-a no rastro e devolve a duração
+    // (para TemposFases). Os tempos do ciclo vêm do relógio do OpenMP, e não de MPI_Wtime, porque
+    // são lidos durante o laço de agentes, quando só a thread de comunicação pode chamar o MPI.
+    inline double fechar_fase(const char* fase, double marca) {
+        double agora = omp_get_wtime();
+        registrar(fase, marca, agora);
+        return agora - marca;
+    }
+}
+
+#endif // RASTRO_HPP
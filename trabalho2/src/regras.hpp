@@ -0,0 +1,22 @@
+#ifndef REGRAS_HPP
+#define REGRAS_HPP
+
+#include "config.hpp"
+
+// Regras da simulação que podem variar entre os cenários de um ensemble (estudos de parâmetros).
+// Os padrões são os de config.hpp; as demais constantes continuam em tempo de compilação.
+struct RegrasCenario {
+    float threshold_reproducao = Config::THRESHOLD_REPRODUCAO;
+    float taxa_regeneracao_cheia = Config::TAXA_REGENERACAO_CHEIA;
+    float taxa_regeneracao_seca = Config::TAXA_REGENERACAO_SECA;
+    float fator_carga_trabalho = Config::FATOR_CARGA_TRABALHO;
+};
+
+namespace Regras {
+    // Regras do cenário que este processo simula. Definidas uma vez em main, antes de criar o
+    // território e os agentes, e só lidas durante a simulação (os kernels copiam o que usam
+    // para variáveis locais antes dos laços).
+    inline RegrasCenario atuais;
+}
+
+#endif // REGRAS_HPP
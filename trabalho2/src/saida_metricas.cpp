@@ -0,0 +1,195 @@
+#include "saida_metricas.hpp"
+#include "config.hpp"
+#include "estrategia_agentes.hpp"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    const char* nome_estacao(int estacao) { return estacao == 0 ? "SECA" : "CHEIA"; }
+
+    float energia_media(const RegistroMetricas& r) {
+        return r.agentes > 0 ? r.energia_total / r.agentes : 0.0f;
+    }
+
+    // String JSON com as aspas (escapa aspas, barra invertida e caracteres de controle)
+    std::string string_json(const std::string& texto) {
+        std::ostringstream s;
+        s << '"';
+        for (char c : texto) {
+            unsigned char u = (unsigned char)c;
+            if (c == '"' || c == '\\') s << '\\' << c;
+            else if (u < 0x20) s << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)u << std::dec;
+            else s << c;
+        }
+        s << '"';
+        return s.str();
+    }
+}
+
+std::string campo_csv(const std::string& texto) {
+    if (texto.find_first_of(",\"\r\n") == std::string::npos) return texto;
+    std::string campo = "\"";
+    for (char c : texto) {
+        if (c == '"') campo += '"';
+        campo += c;
+    }
+    return campo + '"';
+}
+
+SaidaConsole::SaidaConsole(std::vector<std::string> nomes_cenarios, float num_celulas)
+    : nomes_cenarios(std::move(nomes_cenarios)), num_celulas(num_celulas) {}
+
+void SaidaConsole::registrar(const RegistroMetricas& r) {
+    // O quadro é montado inteiro e vai para o terminal de uma vez, com um só flush
+    std::ostringstream texto;
+
+    if (r.rank >= 0) {
+        texto << "    Rank " << std::setw(4) << r.rank << ": " << std::setw(6) << r.agentes << " agentes | +"
+              << std::setw(3) << r.nascimentos << " / -" << std::setw(3) << r.mortes << " | Migração: "
+              << std::setw(5) << r.migracao << " | Recursos: " << std::fixed << std::setprecision(1)
+              << std::setw(8) << r.recursos << " | Agentes: " << std::setw(8) << nome_estrategia((EstrategiaAgentes)r.estrategia_agentes)
+              << std::setprecision(2) << std::setw(9) << r.tempo_agentes * 1e3f << " ms" << '\n';
+        std::cout << texto.str() << std::flush;
+        return;
+    }
+
+    float recursos_medios = r.recursos / num_celulas;
+    bool sustentavel = r.regeneracao >= r.consumo;
+    std::string cenario = nomes_cenarios.size() > 1 ? " " + nomes_cenarios[r.cenario] : "";
+
+    texto << "\033[1;36m" << "┌" << std::string(60, '-') << "┐\033[0m" << '\n';
+    texto << "\033[1;36m| CICLO " << std::setw(4) << r.ciclo << " ["
+          << (r.estacao == 0 ? "\033[1;33mSECA" : "\033[1;34mCHEIA") << "\033[1;36m]" << cenario
+          << std::setw(34) << " |" << "\033[0m" << '\n';
+    texto << "\033[1;36m" << "├" << std::string(60, '-') << "┤\033[0m" << '\n';
+
+    texto << "  Agentes Totais: " << std::setw(6) << r.agentes
+          << " | Energia Média: " << std::fixed << std::setprecision(2) << energia_media(r) << '\n';
+    texto << "  Distribuição:   Min/Max por Proc: " << std::setw(4) << r.min_agentes << " / " << std::setw(4) << r.max_agentes << '\n';
+
+    texto << "  Dinâmica:       " << "\033[1;32m+" << std::setw(3) << r.nascimentos << "\033[0m nascimentos, "
+          << "\033[1;31m-" << std::setw(3) << r.mortes << "\033[0m mortes" << '\n';
+
+    texto << "  Migração:       " << std::setw(5) << r.migracao << " (Ciclo) | "
+          << std::setw(8) << r.migracao_acumulada << " (Acumulada)" << '\n';
+
+    texto << "  Recursos:       " << std::fixed << std::setprecision(1) << std::setw(8) << r.recursos
+          << " (Total) | " << std::setprecision(2) << recursos_medios << " (Méd/Cel)" << '\n';
+
+    texto << "  Sustentabilidade: "
+          << (sustentavel ? "\033[1;32m[POSITIVA]\033[0m" : "\033[1;31m[NEGATIVA]\033[0m")
+          << " (Reg: " << std::fixed << std::setprecision(1) << r.regeneracao
+          << " vs Cons: " << r.consumo << ")" << '\n';
+
+    texto << "\033[1;36m" << "└" << std::string(60, '-') << "┘\033[0m" << '\n';
+    std::cout << texto.str() << std::flush;
+}
+
+SaidaArquivo::SaidaArquivo(Formato formato, std::vector<std::string> nomes_cenarios, const std::string& caminho)
+    : formato(formato), destino(&std::cout), cabecalho_escrito(false) {
+    // Os nomes dos cenários vêm do arquivo de cenários: já ficam escapados para o formato
+    for (const std::string& nome : nomes_cenarios) {
+        this->nomes_cenarios.push_back(formato == Formato::CSV ? campo_csv(nome) : string_json(nome));
+    }
+    if (!caminho.empty()) {
+        destino = abrir_com_buffer(arquivo, buffer, 1 << 20, caminho) ? &arquivo : nullptr;
+    }
+    linha << std::fixed;
+}
+
+void SaidaArquivo::registrar(const RegistroMetricas& r) {
+    // O cabeçalho sai com o primeiro registro, depois do que o programa imprime antes dos ciclos
+    if (formato == Formato::CSV && !cabecalho_escrito) {
+        *destino << "cenario,ciclo,estacao,rank,agentes,min_agentes,max_agentes,nascimentos,mortes,migracao,"
+                    "migracao_acumulada,recursos,consumo,regeneracao,energia_media,estrategia_agentes,tempo_agentes\n";
+        cabecalho_escrito = true;
+    }
+
+    linha.str("");
+    std::ostream& s = linha;
+    bool global = r.rank < 0;
+
+    if (formato == Formato::CSV) {
+        s << nomes_cenarios[r.cenario] << ',' << r.ciclo << ',' << nome_estacao(r.estacao) << ',';
+        if (!global) s << r.rank;
+        s << ',' << r.agentes << ',';
+        if (global) s << r.min_agentes << ',' << r.max_agentes;
+        else s << ',';
+        s << ',' << r.nascimentos << ',' << r.mortes << ',' << r.migracao << ',';
+        if (global) s << r.migracao_acumulada;
+        s << ',' << std::setprecision(1) << r.recursos << ',' << r.consumo << ',' << r.regeneracao << ','
+          << std::setprecision(2) << energia_media(r) << ',';
+        if (!global) s << nome_estrategia((EstrategiaAgentes)r.estrategia_agentes);
+        s << ',' << std::setprecision(6) << r.tempo_agentes << '\n';
+        *destino << linha.str();
+        return;
+    }
+
+    s << "{\"cenario\":" << nomes_cenarios[r.cenario] << ",\"ciclo\":" << r.ciclo
+      << ",\"estacao\":\"" << nome_estacao(r.estacao) << '"';
+    if (!global) s << ",\"rank\":" << r.rank;
+    s << ",\"agentes\":" << r.agentes;
+    if (global) s << ",\"min_agentes\":" << r.min_agentes << ",\"max_agentes\":" << r.max_agentes;
+    s << ",\"nascimentos\":" << r.nascimentos << ",\"mortes\":" << r.mortes << ",\"migracao\":" << r.migracao;
+    if (global) s << ",\"migracao_acumulada\":" << r.migracao_acumulada;
+    s << std::setprecision(1) << ",\"recursos\":" << r.recursos << ",\"consumo\":" << r.consumo
+      << ",\"regeneracao\":" << r.regeneracao << std::setprecision(2) << ",\"energia_media\":" << energia_media(r);
+    if (!global) s << ",\"estrategia_agentes\":\"" << nome_estrategia((EstrategiaAgentes)r.estrategia_agentes) << '"';
+    s << std::setprecision(6) << ",\"tempo_agentes\":" << r.tempo_agentes << "}\n";
+    *destino << linha.str();
+}
+
+void SaidaArquivo::esvaziar() {
+    destino->flush();
+}
+
+SaidaAssincrona::SaidaAssincrona(std::unique_ptr<SaidaMetricas> destino)
+    : destino(std::move(destino)),
+      escritora([this](std::vector<RegistroMetricas>& lote) {
+          for (const RegistroMetricas& r : lote) this->destino->registrar(r);
+      }) {}
+
+SaidaAssincrona::~SaidaAssincrona() {
+    escritora.fechar();
+    destino->esvaziar();
+}
+
+void SaidaAssincrona::registrar(const RegistroMetricas& registro) {
+    escritora.enfileirar(registro);
+}
+
+void SaidaAssincrona::esvaziar() {
+    escritora.esperar();
+    destino->esvaziar();
+}
+
+SaidaMetricas* criar_saida_metricas(const std::string& descricao, const std::vector<std::string>& nomes_cenarios,
+                                    float num_celulas, std::string& erro) {
+    size_t separador = descricao.find(':');
+    std::string tipo = descricao.substr(0, separador);
+    std::string caminho = separador == std::string::npos ? "" : descricao.substr(separador + 1);
+
+    std::unique_ptr<SaidaMetricas> saida;
+    if (tipo == "console" && separador == std::string::npos) {
+        saida.reset(new SaidaConsole(nomes_cenarios, num_celulas));
+    } else if (tipo == "csv" || tipo == "jsonl") {
+        if (separador != std::string::npos && caminho.empty()) {
+            erro = "arquivo vazio em --metricas " + descricao;
+            return nullptr;
+        }
+        auto formato = tipo == "csv" ? SaidaArquivo::Formato::CSV : SaidaArquivo::Formato::JSONL;
+        SaidaArquivo* arquivo = new SaidaArquivo(formato, nomes_cenarios, caminho);
+        saida.reset(arquivo);
+        if (!arquivo->ok()) {
+            erro = "não consegui criar o arquivo de métricas " + caminho;
+            return nullptr;
+        }
+    } else {
+        erro = "destino de métricas inválido: " + descricao + " (console, csv[:arquivo] ou jsonl[:arquivo])";
+        return nullptr;
+    }
+
+    if (Config::METRICAS_ASSINCRONAS) return new SaidaAssincrona(std::move(saida));
+    return saida.release();
+}
@@ -0,0 +1,100 @@
+#ifndef SAIDA_METRICAS_HPP
+#define SAIDA_METRICAS_HPP
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "escritora.hpp"
+
+// Totais de um ciclo já reduzidos entre os processos (rank == -1) ou, no detalhamento por
+// processo, os valores locais de um rank. Campos que não se aplicam a uma linha por rank
+// (mínimo/máximo de agentes, migração acumulada) ficam vazios na saída.
+struct RegistroMetricas {
+    int cenario;
+    int ciclo;
+    int estacao;                  // Estacao como int (0: SECA, 1: CHEIA)
+    int rank;                     // -1: totais globais
+    int agentes;
+    int min_agentes;
+    int max_agentes;
+    int nascimentos;
+    int mortes;
+    int migracao;
+    long long migracao_acumulada;
+    float recursos;
+    float consumo;
+    float regeneracao;
+    float energia_total;
+    int estrategia_agentes;       // EstrategiaAgentes do rank (-1 nos totais globais)
+    float tempo_agentes;          // Laço de agentes do ciclo (s): do rank, ou o mais lento nos totais
+};
+
+// Destino das métricas de cada ciclo. Só o rank 0 (de cada cenário) tem um; os demais passam nullptr.
+class SaidaMetricas {
+public:
+    virtual ~SaidaMetricas() = default;
+    virtual void registrar(const RegistroMetricas& registro) = 0;
+    // Garante que tudo o que foi registrado já está no destino (antes das impressões finais)
+    virtual void esvaziar() {}
+};
+
+// Painel colorido de sempre no terminal, um quadro por ciclo (linhas por rank logo abaixo)
+class SaidaConsole : public SaidaMetricas {
+private:
+    std::vector<std::string> nomes_cenarios;
+    float num_celulas;  // Para os recursos médios por célula
+
+public:
+    SaidaConsole(std::vector<std::string> nomes_cenarios, float num_celulas);
+    void registrar(const RegistroMetricas& registro) override;
+};
+
+// Uma linha por registro em CSV (com cabeçalho) ou JSON lines, num arquivo ou na saída padrão.
+// O arquivo usa um buffer grande e só é descarregado em esvaziar().
+class SaidaArquivo : public SaidaMetricas {
+public:
+    enum class Formato { CSV, JSONL };
+
+private:
+    Formato formato;
+    std::vector<std::string> nomes_cenarios; // Já escapados (campo CSV ou string JSON com as aspas)
+    std::ofstream arquivo;
+    std::vector<char> buffer;
+    std::ostream* destino;
+    std::ostringstream linha;     // Formatação de cada linha (sem mexer no estado do std::cout)
+    bool cabecalho_escrito;
+
+public:
+    // caminho vazio: saída padrão. Se o arquivo não abrir, ok() fica false.
+    SaidaArquivo(Formato formato, std::vector<std::string> nomes_cenarios, const std::string& caminho);
+    bool ok() const { return destino != nullptr; }
+    void registrar(const RegistroMetricas& registro) override;
+    void esvaziar() override;
+};
+
+// Tira a formatação e a escrita do caminho do ciclo: o rank 0 só copia o registro para a fila de
+// uma EscritoraAssincrona, que o repassa ao destino real
+class SaidaAssincrona : public SaidaMetricas {
+private:
+    std::unique_ptr<SaidaMetricas> destino;
+    EscritoraAssincrona<RegistroMetricas> escritora; // Depois do destino: encerra antes dele
+
+public:
+    explicit SaidaAssincrona(std::unique_ptr<SaidaMetricas> destino);
+    ~SaidaAssincrona() override;
+    void registrar(const RegistroMetricas& registro) override;
+    void esvaziar() override;
+};
+
+// Campo CSV (RFC 4180): entre aspas, com as aspas dobradas, se tiver vírgula, aspas ou quebra de linha
+std::string campo_csv(const std::string& texto);
+
+// Cria o destino descrito por `descricao`: "console", "csv", "jsonl", "csv:<arquivo>" ou
+// "jsonl:<arquivo>" (sem arquivo, na saída padrão), assíncrono se Config::METRICAS_ASSINCRONAS.
+// Retorna nullptr e descreve o problema em `erro` se a descrição for inválida ou o arquivo não abrir.
+SaidaMetricas* criar_saida_metricas(const std::string& descricao, const std::vector<std::string>& nomes_cenarios,
+                                    float num_celulas, std::string& erro);
+
+#endif // SAIDA_METRICAS_HPP
@@ -0,0 +1,246 @@
+#ifndef SEM_MPI_MPI_H
+#define SEM_MPI_MPI_H
+
+// Substituto de <mpi.h> para o build sem MPI (make nompi): um único processo, só OpenMP.
+//
+// Entra no lugar do cabeçalho real pelo caminho de include (-Isrc/sem_mpi) e implementa apenas
+// o subconjunto da API usado pelo trabalho2, com a semântica de MPI_COMM_WORLD de tamanho 1:
+// todo vizinho é MPI_PROC_NULL (envios e recepções viram no-ops), reduções copiam a entrada
+// para a saída, barreiras não fazem nada e a "janela compartilhada" é memória comum. Os
+// datatypes derivados (contíguo e vetor) são descritos de verdade para que MPI_Pack funcione.
+// Comunicação ponto a ponto com um rank real (só poderia ser o próprio 0) aborta com mensagem.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef SEM_MPI
+#define SEM_MPI 1
+#endif
+
+typedef int MPI_Comm;
+typedef int MPI_Group;
+typedef int MPI_Info;
+typedef int MPI_Op;
+typedef int MPI_Request;
+typedef std::ptrdiff_t MPI_Aint;
+
+struct SemMpiTipo {
+    int tamanho;                // Bytes de dados de um elemento
+    MPI_Aint extensao;          // Distância em bytes entre elementos consecutivos
+    int blocos;                 // Tipos derivados: `blocos` blocos de `bloco` elementos da base,
+    int bloco;                  // começando a cada `passo` elementos da base
+    MPI_Aint passo;
+    const SemMpiTipo* base;     // nullptr nos tipos predefinidos
+};
+typedef const SemMpiTipo* MPI_Datatype;
+
+struct MPI_Status {
+    int MPI_SOURCE;
+    int MPI_TAG;
+    int MPI_ERROR;
+    int bytes;
+};
+
+struct SemMpiJanela {
+    void* memoria;
+    MPI_Aint tamanho;
+    int unidade;
+};
+typedef SemMpiJanela* MPI_Win;
+
+namespace sem_mpi {
+    inline const SemMpiTipo BYTE{1, 1, 1, 1, 1, nullptr};
+    inline const SemMpiTipo INT{sizeof(int), sizeof(int), 1, 1, 1, nullptr};
+    inline const SemMpiTipo FLOAT{sizeof(float), sizeof(float), 1, 1, 1, nullptr};
+    inline const SemMpiTipo DOUBLE{sizeof(double), sizeof(double), 1, 1, 1, nullptr};
+    inline const SemMpiTipo LONG_LONG{sizeof(long long), sizeof(long long), 1, 1, 1, nullptr};
+
+    [[noreturn]] inline void abortar(const char* funcao) {
+        std::fprintf(stderr, "%s: comunicação com outro rank no build sem MPI\n", funcao);
+        std::exit(1);
+    }
+
+    // Copia um elemento de `tipo` de `origem` para `destino` (empacotado), avançando `destino`
+    inline void empacotar(const char* origem, MPI_Datatype tipo, char*& destino) {
+        if (!tipo->base) {
+            std::memcpy(destino, origem, tipo->tamanho);
+            destino += tipo->tamanho;
+            return;
+        }
+        const SemMpiTipo* base = tipo->base;
+        bool base_contigua = base->tamanho == base->extensao;
+        for (int b = 0; b < tipo->blocos; ++b) {
+            const char* bloco = origem + b * tipo->passo * base->extensao;
+            if (base_contigua) {
+                std::memcpy(destino, bloco, (size_t)tipo->bloco * base->tamanho);
+                destino += (size_t)tipo->bloco * base->tamanho;
+            } else {
+                for (int e = 0; e < tipo->bloco; ++e) empacotar(bloco + e * base->extensao, base, destino);
+            }
+        }
+    }
+}
+
+#define MPI_COMM_NULL 0
+#define MPI_COMM_WORLD 1
+#define MPI_COMM_SELF 2
+#define MPI_INFO_NULL 0
+#define MPI_REQUEST_NULL 0
+#define MPI_PROC_NULL (-2)
+#define MPI_UNDEFINED (-32766)
+#define MPI_SUCCESS 0
+#define MPI_SUM 1
+#define MPI_MAX 2
+#define MPI_THREAD_SINGLE 0
+#define MPI_THREAD_FUNNELED 1
+#define MPI_THREAD_SERIALIZED 2
+#define MPI_THREAD_MULTIPLE 3
+#define MPI_COMM_TYPE_SHARED 1
+#define MPI_MODE_NOCHECK 1024
+#define MPI_BYTE (&sem_mpi::BYTE)
+#define MPI_INT (&sem_mpi::INT)
+#define MPI_FLOAT (&sem_mpi::FLOAT)
+#define MPI_DOUBLE (&sem_mpi::DOUBLE)
+#define MPI_LONG_LONG (&sem_mpi::LONG_LONG)
+#define MPI_STATUS_IGNORE (static_cast<MPI_Status*>(nullptr))
+#define MPI_STATUSES_IGNORE (static_cast<MPI_Status*>(nullptr))
+#define MPI_IN_PLACE (reinterpret_cast<void*>(-1))
+
+// Ambiente
+inline int MPI_Init(int*, char***) { return MPI_SUCCESS; }
+inline int MPI_Init_thread(int*, char***, int, int* fornecido) { *fornecido = MPI_THREAD_MULTIPLE; return MPI_SUCCESS; }
+inline int MPI_Finalize() { return MPI_SUCCESS; }
+inline int MPI_Abort(MPI_Comm, int codigo) { std::exit(codigo); }
+inline double MPI_Wtime() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Comunicadores e grupos (só o rank 0)
+inline int MPI_Comm_rank(MPI_Comm, int* rank) { *rank = 0; return MPI_SUCCESS; }
+inline int MPI_Comm_size(MPI_Comm, int* size) { *size = 1; return MPI_SUCCESS; }
+inline int MPI_Comm_split_type(MPI_Comm, int, int, MPI_Info, MPI_Comm* novo) { *novo = MPI_COMM_SELF; return MPI_SUCCESS; }
+inline int MPI_Comm_split(MPI_Comm, int cor, int, MPI_Comm* novo) {
+    *novo = cor == MPI_UNDEFINED ? MPI_COMM_NULL : MPI_COMM_SELF;
+    return MPI_SUCCESS;
+}
+inline int MPI_Comm_free(MPI_Comm* comm) { *comm = MPI_COMM_NULL; return MPI_SUCCESS; }
+inline int MPI_Comm_group(MPI_Comm, MPI_Group* grupo) { *grupo = 1; return MPI_SUCCESS; }
+inline int MPI_Group_free(MPI_Group* grupo) { *grupo = 0; return MPI_SUCCESS; }
+inline int MPI_Group_translate_ranks(MPI_Group, int n, const int* ranks, MPI_Group, int* traduzidos) {
+    for (int i = 0; i < n; ++i) traduzidos[i] = ranks[i] == 0 ? 0 : MPI_UNDEFINED;
+    return MPI_SUCCESS;
+}
+inline int MPI_Info_create(MPI_Info* info) { *info = MPI_INFO_NULL; return MPI_SUCCESS; }
+inline int MPI_Info_set(MPI_Info, const char*, const char*) { return MPI_SUCCESS; }
+inline int MPI_Info_free(MPI_Info* info) { *info = MPI_INFO_NULL; return MPI_SUCCESS; }
+
+// Datatypes
+inline int MPI_Type_contiguous(int n, MPI_Datatype base, MPI_Datatype* novo) {
+    *novo = new SemMpiTipo{n * base->tamanho, n * base->extensao, 1, n, 0, base};
+    return MPI_SUCCESS;
+}
+inline int MPI_Type_vector(int blocos, int bloco, int passo, MPI_Datatype base, MPI_Datatype* novo) {
+    MPI_Aint extensao = blocos > 0 ? ((MPI_Aint)(blocos - 1) * passo + bloco) * base->extensao : 0;
+    *novo = new SemMpiTipo{blocos * bloco * base->tamanho, extensao, blocos, bloco, passo, base};
+    return MPI_SUCCESS;
+}
+inline int MPI_Type_commit(MPI_Datatype*) { return MPI_SUCCESS; }
+inline int MPI_Type_free(MPI_Datatype* tipo) { delete *tipo; *tipo = nullptr; return MPI_SUCCESS; }
+inline int MPI_Pack_size(int n, MPI_Datatype tipo, MPI_Comm, int* bytes) { *bytes = n * tipo->tamanho; return MPI_SUCCESS; }
+inline int MPI_Pack(const void* entrada, int n, MPI_Datatype tipo, void* saida, int, int* posicao, MPI_Comm) {
+    char* destino = static_cast<char*>(saida) + *posicao;
+    for (int i = 0; i < n; ++i) sem_mpi::empacotar(static_cast<const char*>(entrada) + i * tipo->extensao, tipo, destino);
+    *posicao = (int)(destino - static_cast<char*>(saida));
+    return MPI_SUCCESS;
+}
+
+// Ponto a ponto: só com MPI_PROC_NULL (concluem na hora, sem dados)
+inline int MPI_Isend(const void*, int, MPI_Datatype, int destino, int, MPI_Comm, MPI_Request* req) {
+    if (destino != MPI_PROC_NULL) sem_mpi::abortar("MPI_Isend");
+    *req = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+}
+inline int MPI_Irecv(void*, int, MPI_Datatype, int origem, int, MPI_Comm, MPI_Request* req) {
+    if (origem != MPI_PROC_NULL) sem_mpi::abortar("MPI_Irecv");
+    *req = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+}
+inline int MPI_Recv_init(void*, int, MPI_Datatype, int origem, int, MPI_Comm, MPI_Request* req) {
+    if (origem != MPI_PROC_NULL) sem_mpi::abortar("MPI_Recv_init");
+    *req = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+}
+inline int MPI_Recv(void*, int, MPI_Datatype, int origem, int, MPI_Comm, MPI_Status*) {
+    if (origem != MPI_PROC_NULL) sem_mpi::abortar("MPI_Recv");
+    return MPI_SUCCESS;
+}
+inline int MPI_Probe(int origem, int, MPI_Comm, MPI_Status* status) {
+    if (origem != MPI_PROC_NULL) sem_mpi::abortar("MPI_Probe");
+    if (status) *status = MPI_Status{MPI_PROC_NULL, 0, MPI_SUCCESS, 0};
+    return MPI_SUCCESS;
+}
+inline int MPI_Get_count(const MPI_Status* status, MPI_Datatype tipo, int* n) { *n = status->bytes / tipo->tamanho; return MPI_SUCCESS; }
+inline int MPI_Start(MPI_Request*) { return MPI_SUCCESS; }
+inline int MPI_Cancel(MPI_Request*) { return MPI_SUCCESS; }
+inline int MPI_Request_free(MPI_Request* req) { *req = MPI_REQUEST_NULL; return MPI_SUCCESS; }
+inline int MPI_Wait(MPI_Request* req, MPI_Status*) { *req = MPI_REQUEST_NULL; return MPI_SUCCESS; }
+inline int MPI_Waitall(int n, MPI_Request* reqs, MPI_Status*) {
+    for (int i = 0; i < n; ++i) reqs[i] = MPI_REQUEST_NULL;
+    return MPI_SUCCESS;
+}
+inline int MPI_Test(MPI_Request* req, int* concluido, MPI_Status* status) {
+    *req = MPI_REQUEST_NULL;
+    *concluido = 1;
+    if (status) *status = MPI_Status{MPI_PROC_NULL, 0, MPI_SUCCESS, 0};
+    return MPI_SUCCESS;
+}
+
+// Coletivas com um processo
+inline int MPI_Barrier(MPI_Comm) { return MPI_SUCCESS; }
+inline int MPI_Bcast(void*, int, MPI_Datatype, int, MPI_Comm) { return MPI_SUCCESS; }
+inline int MPI_Allreduce(const void* entrada, void* saida, int n, MPI_Datatype tipo, MPI_Op, MPI_Comm) {
+    if (entrada != MPI_IN_PLACE) std::memcpy(saida, entrada, (size_t)n * tipo->tamanho);
+    return MPI_SUCCESS;
+}
+inline int MPI_Reduce(const void* entrada, void* saida, int n, MPI_Datatype tipo, MPI_Op op, int, MPI_Comm comm) {
+    return MPI_Allreduce(entrada, saida, n, tipo, op, comm);
+}
+inline int MPI_Exscan(const void*, void*, int, MPI_Datatype, MPI_Op, MPI_Comm) { return MPI_SUCCESS; } // Indefinido no rank 0
+inline int MPI_Gather(const void* entrada, int n, MPI_Datatype tipo, void* saida, int, MPI_Datatype, int, MPI_Comm) {
+    std::memcpy(saida, entrada, (size_t)n * tipo->tamanho);
+    return MPI_SUCCESS;
+}
+inline int MPI_Gatherv(const void* entrada, int n, MPI_Datatype tipo, void* saida, const int*, const int* deslocamentos,
+                       MPI_Datatype, int, MPI_Comm) {
+    std::memcpy(static_cast<char*>(saida) + (size_t)deslocamentos[0] * tipo->tamanho, entrada, (size_t)n * tipo->tamanho);
+    return MPI_SUCCESS;
+}
+
+// Janela "compartilhada" de um único rank: memória comum, alinhada em linha de cache
+inline int MPI_Win_allocate_shared(MPI_Aint tamanho, int unidade, MPI_Info, MPI_Comm, void* base, MPI_Win* janela) {
+    size_t bytes = ((size_t)tamanho + 63) / 64 * 64;
+    void* memoria = bytes ? std::aligned_alloc(64, bytes) : nullptr;
+    *static_cast<void**>(base) = memoria;
+    *janela = new SemMpiJanela{memoria, tamanho, unidade};
+    return MPI_SUCCESS;
+}
+inline int MPI_Win_shared_query(MPI_Win janela, int, MPI_Aint* tamanho, int* unidade, void* base) {
+    *tamanho = janela->tamanho;
+    *unidade = janela->unidade;
+    *static_cast<void**>(base) = janela->memoria;
+    return MPI_SUCCESS;
+}
+inline int MPI_Win_lock_all(int, MPI_Win) { return MPI_SUCCESS; }
+inline int MPI_Win_unlock_all(MPI_Win) { return MPI_SUCCESS; }
+inline int MPI_Win_sync(MPI_Win) { return MPI_SUCCESS; }
+inline int MPI_Win_free(MPI_Win* janela) {
+    std::free((*janela)->memoria);
+    delete *janela;
+    *janela = nullptr;
+    return MPI_SUCCESS;
+}
+
+#endif // SEM_MPI_MPI_H
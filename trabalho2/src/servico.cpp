@@ -0,0 +1,235 @@
+#include "servico.hpp"
+#include "coletivas.hpp"
+#include "ensemble.hpp"
+#include "tabela_somas.hpp"
+#include <omp.h>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <vector>
+
+static_assert(std::is_trivially_copyable<Comando>::value, "Comando é difundido como bytes");
+
+namespace {
+    const char* nome_estacao(Estacao estacao) { return estacao == Estacao::SECA ? "SECA" : "CHEIA"; }
+
+    // Um agente no snapshot
+    struct RegistroAgente {
+        int x;
+        int y;
+        float energia;
+    };
+
+    // Coletiva: resposta de `ciclos` e `estado`, com os totais atuais de todos os ranks. O recurso
+    // local vem da tabela de somas (em double), como nas consultas `recursos`: o total da grade
+    // sai igual ao de `recursos 0 0 L A` no mesmo ciclo
+    void responder_estado(MPI_Comm comm, int rank, int ciclo, const Territorio& subgrid, const VetorAgentes& agentes,
+                          double recursos_locais) {
+        double local[2] = {(double)agentes.size(), recursos_locais};
+        double global[2] = {0.0, 0.0};
+        MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_SUM, 0, comm);
+        if (rank != 0) return;
+
+        std::ostringstream resposta;
+        resposta << "ok ciclo=" << ciclo << " estacao=" << nome_estacao(subgrid.get_estacao())
+                 << " agentes=" << (long long)global[0] << " recursos=" << std::fixed << std::setprecision(1) << global[1];
+        std::cout << resposta.str() << std::endl;
+    }
+}
+
+bool interpretar_comando(const std::string& linha, const Parametros& parametros, Comando& comando, std::string& erro) {
+    std::istringstream campos(linha);
+    std::string nome;
+    campos >> nome;
+    comando = Comando{};
+
+    if (nome == "ciclos") {
+        comando.tipo = TipoComando::CICLOS;
+        if (!(campos >> comando.ciclos) || comando.ciclos <= 0) {
+            erro = "uso: ciclos N (N > 0)";
+            return false;
+        }
+    } else if (nome == "regras") {
+        // Sobre as regras vigentes; a semente só vale para a população inicial
+        comando.tipo = TipoComando::REGRAS;
+        Cenario cenario;
+        cenario.regras = Regras::atuais;
+        std::string par;
+        int pares = 0;
+        while (campos >> par) {
+            size_t igual = par.find('=');
+            std::string chave = par.substr(0, igual);
+            if (igual == std::string::npos || chave == "semente" ||
+                !aplicar_parametro(cenario, chave, par.substr(igual + 1))) {
+                erro = "parâmetro inválido " + par;
+                return false;
+            }
+            ++pares;
+        }
+        if (pares == 0) {
+            erro = "uso: regras chave=valor ...";
+            return false;
+        }
+        comando.regras = cenario.regras;
+        return true;
+    } else if (nome == "recursos") {
+        comando.tipo = TipoComando::RECURSOS;
+        if (!(campos >> comando.x0 >> comando.y0 >> comando.x1 >> comando.y1) ||
+            comando.x0 < 0 || comando.x0 >= comando.x1 || comando.x1 > parametros.largura_grid ||
+            comando.y0 < 0 || comando.y0 >= comando.y1 || comando.y1 > parametros.altura_grid) {
+            erro = "uso: recursos x0 y0 x1 y1 (0 <= x0 < x1 <= " + std::to_string(parametros.largura_grid) +
+                   ", 0 <= y0 < y1 <= " + std::to_string(parametros.altura_grid) + ")";
+            return false;
+        }
+    } else if (nome == "snapshot") {
+        comando.tipo = TipoComando::SNAPSHOT;
+        std::string arquivo;
+        if (!(campos >> arquivo) || arquivo.size() >= sizeof(comando.arquivo)) {
+            erro = "uso: snapshot <arquivo>";
+            return false;
+        }
+        std::strcpy(comando.arquivo, arquivo.c_str());
+    } else if (nome == "estado") {
+        comando.tipo = TipoComando::ESTADO;
+    } else if (nome == "sair") {
+        comando.tipo = TipoComando::SAIR;
+    } else {
+        erro = "comando desconhecido: " + nome + " (ciclos, regras, recursos, estado, snapshot, sair)";
+        return false;
+    }
+
+    std::string resto;
+    if (campos >> resto) {
+        erro = "argumento a mais: " + resto;
+        return false;
+    }
+    return true;
+}
+
+double atender_comandos(MPI_Comm comm, int rank, Parametros& parametros, int& ciclo, const Territorio& subgrid,
+                        const VetorAgentes& agentes, SaidaMetricas* saida, const std::function<void(int)>& avancar_ciclo) {
+    double tempo_ciclos = 0.0;
+
+    // Tabela de somas das consultas de região e dos totais, reconstruída uma vez por estado
+    TabelaSomas tabela;
+    int ciclo_tabela = -1;
+    auto tabela_atual = [&]() -> const TabelaSomas& {
+        if (ciclo_tabela != ciclo) {
+            tabela.construir(subgrid, agentes.data(), (int)agentes.size());
+            ciclo_tabela = ciclo;
+        }
+        return tabela;
+    };
+    auto recursos_locais = [&]() {
+        return tabela_atual().recursos(0, 0, parametros.largura_grid, parametros.altura_grid);
+    };
+
+    while (true) {
+        // O rank 0 lê até ter um comando válido (os inválidos só ele responde); os demais esperam no Bcast
+        Comando comando{};
+        if (rank == 0) {
+            std::string linha, erro;
+            while (true) {
+                if (!std::getline(std::cin, linha)) {
+                    comando.tipo = TipoComando::SAIR;
+                    break;
+                }
+                std::istringstream campos(linha);
+                std::string primeiro;
+                if (!(campos >> primeiro) || primeiro[0] == '#') continue;
+                if (interpretar_comando(linha, parametros, comando, erro)) break;
+                std::cout << "erro " << erro << std::endl;
+            }
+        }
+        MPI_Bcast(&comando, sizeof(Comando), MPI_BYTE, 0, comm);
+
+        switch (comando.tipo) {
+            case TipoComando::CICLOS: {
+                parametros.total_ciclos = ciclo + comando.ciclos;
+                MPI_Barrier(comm);
+                double inicio = omp_get_wtime();
+                for (; ciclo < parametros.total_ciclos; ++ciclo) avancar_ciclo(ciclo);
+                // As métricas do comando saem antes da resposta
+                if (saida) saida->esvaziar();
+                tempo_ciclos += omp_get_wtime() - inicio;
+                responder_estado(comm, rank, ciclo, subgrid, agentes, recursos_locais());
+                break;
+            }
+            case TipoComando::ESTADO:
+                responder_estado(comm, rank, ciclo, subgrid, agentes, recursos_locais());
+                break;
+            case TipoComando::REGRAS:
+                Regras::atuais = comando.regras;
+                if (rank == 0) {
+                    std::cout << "ok threshold_reproducao=" << Regras::atuais.threshold_reproducao
+                              << " taxa_regeneracao_cheia=" << Regras::atuais.taxa_regeneracao_cheia
+                              << " taxa_regeneracao_seca=" << Regras::atuais.taxa_regeneracao_seca
+                              << " fator_carga_trabalho=" << Regras::atuais.fator_carga_trabalho << std::endl;
+                }
+                break;
+            case TipoComando::RECURSOS: {
+                // Cada rank responde pela sua faixa em O(1)
+                const TabelaSomas& somas = tabela_atual();
+                double local[2] = {somas.recursos(comando.x0, comando.y0, comando.x1, comando.y1),
+                                   (double)somas.agentes(comando.x0, comando.y0, comando.x1, comando.y1)};
+                double global[2] = {0.0, 0.0};
+                MPI_Reduce(local, global, 2, MPI_DOUBLE, MPI_SUM, 0, comm);
+                if (rank == 0) {
+                    long long celulas = (long long)(comando.x1 - comando.x0) * (comando.y1 - comando.y0);
+                    std::ostringstream resposta;
+                    resposta << "ok recursos=" << std::fixed << std::setprecision(1) << global[0]
+                             << " media=" << std::setprecision(3) << global[0] / celulas
+                             << " agentes=" << (long long)global[1] << " celulas=" << celulas;
+                    std::cout << resposta.str() << std::endl;
+                }
+                break;
+            }
+            case TipoComando::SNAPSHOT: {
+                bool ok = gravar_snapshot(comm, rank, ciclo, subgrid, agentes, parametros.largura_grid,
+                                          parametros.altura_grid, comando.arquivo);
+                if (rank == 0) {
+                    if (ok) std::cout << "ok snapshot=" << comando.arquivo << std::endl;
+                    else std::cout << "erro não consegui criar o arquivo " << comando.arquivo << std::endl;
+                }
+                break;
+            }
+            case TipoComando::SAIR:
+                parametros.total_ciclos = ciclo;
+                if (rank == 0) std::cout << "ok" << std::endl;
+                return tempo_ciclos;
+        }
+    }
+}
+
+bool gravar_snapshot(MPI_Comm comm, int rank, int ciclo, const Territorio& subgrid, const VetorAgentes& agentes,
+                     int largura_grid, int altura_grid, const std::string& arquivo) {
+    // Grade: as faixas têm a mesma altura e estão na ordem dos ranks, então um Gather basta
+    int w = subgrid.get_largura(), h = subgrid.get_altura();
+    std::vector<float> faixa((size_t)w * h);
+    for (int y = 0; y < h; ++y) {
+        const float* linha = subgrid.ptr_recurso(Posicao(0, y));
+        std::copy(linha, linha + w, &faixa[(size_t)y * w]);
+    }
+    std::vector<float> grade(rank == 0 ? (size_t)largura_grid * altura_grid : 0);
+    MPI_Gather(faixa.data(), w * h, MPI_FLOAT, grade.data(), w * h, MPI_FLOAT, 0, comm);
+
+    // Agentes: a quantidade varia entre os ranks
+    std::vector<RegistroAgente> locais(agentes.size());
+    for (size_t i = 0; i < agentes.size(); ++i) {
+        Posicao p = agentes[i].get_posicao();
+        locais[i] = RegistroAgente{p.x, p.y, agentes[i].get_energia()};
+    }
+    std::vector<RegistroAgente> todos = juntar_bytes(comm, locais);
+
+    if (rank != 0) return true;
+    std::ofstream saida(arquivo, std::ios::binary);
+    if (!saida) return false;
+    saida << "trabalho2-snapshot ciclo=" << ciclo << " estacao=" << nome_estacao(subgrid.get_estacao())
+          << " largura=" << largura_grid << " altura=" << altura_grid << " agentes=" << todos.size() << '\n';
+    saida.write(reinterpret_cast<const char*>(grade.data()), (std::streamsize)(grade.size() * sizeof(float)));
+    saida.write(reinterpret_cast<const char*>(todos.data()), (std::streamsize)(todos.size() * sizeof(RegistroAgente)));
+    return (bool)saida;
+}
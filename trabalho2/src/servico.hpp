@@ -0,0 +1,59 @@
+#ifndef SERVICO_HPP
+#define SERVICO_HPP
+
+#include <mpi.h>
+#include <functional>
+#include <string>
+#include "agente.hpp"
+#include "territorio.hpp"
+#include "parametros.hpp"
+#include "regras.hpp"
+#include "saida_metricas.hpp"
+
+// Modo serviço (--servico): em vez de rodar total_ciclos e sair, o job fica de pé com o estado
+// distribuído (grade, agentes, canal de migração) residente e avança sob comando. O rank 0 lê
+// uma linha por comando da entrada padrão, interpreta e a difunde (MPI_Bcast) para o comunicador;
+// todos executam o comando juntos e o rank 0 responde com uma linha "ok ..." ou "erro ...".
+// Entre dois comandos a simulação fica parada; `ciclos N` continua de onde parou.
+//
+//     ciclos N                    avança N ciclos (métricas pelo destino de --metricas)
+//     regras chave=valor ...      troca regras do cenário (chaves do arquivo de cenários, menos semente)
+//     recursos x0 y0 x1 y1        recurso (total e médio por célula) e agentes no retângulo global
+//                                 [x0, x1) x [y0, y1), pela TabelaSomas de cada rank
+//     estado                      ciclo, estação, agentes e recursos totais
+//     snapshot <arquivo>          grava a grade de recursos e os agentes (formato em gravar_snapshot)
+//     sair                        encerra (o fim da entrada também)
+//
+// Linhas vazias e as iniciadas por '#' são ignoradas.
+enum class TipoComando { CICLOS, REGRAS, RECURSOS, ESTADO, SNAPSHOT, SAIR };
+
+// Comando já interpretado, difundido como bytes
+struct Comando {
+    TipoComando tipo;
+    int ciclos;             // CICLOS
+    int x0, y0, x1, y1;     // RECURSOS
+    RegrasCenario regras;   // REGRAS: as regras completas, já com as alterações
+    char arquivo[256];      // SNAPSHOT
+};
+
+// Interpreta uma linha de comando sobre as regras atuais. Retorna false e descreve o problema em
+// `erro` se o comando for desconhecido ou os argumentos inválidos.
+bool interpretar_comando(const std::string& linha, const Parametros& parametros, Comando& comando, std::string& erro);
+
+// Coletiva em `comm`: atende comandos até `sair` ou o fim da entrada. `avancar_ciclo(t)` roda o
+// ciclo t inteiro (o corpo do laço do modo em lote); `ciclo` é o próximo ciclo a rodar e
+// `parametros.total_ciclos` acompanha o fim de cada `ciclos N` (o último ciclo do comando sempre
+// emite métricas). Retorna o tempo de parede gasto nos ciclos (sem a espera por comandos).
+double atender_comandos(MPI_Comm comm, int rank, Parametros& parametros, int& ciclo, const Territorio& subgrid,
+                        const VetorAgentes& agentes, SaidaMetricas* saida, const std::function<void(int)>& avancar_ciclo);
+
+// Coletiva em `comm`: grava no rank 0 o estado do ciclo. Uma linha de texto de cabeçalho,
+//
+//     trabalho2-snapshot ciclo=<t> estacao=<SECA|CHEIA> largura=<L> altura=<A> agentes=<N>
+//
+// seguida, em binário nativo, da grade de recursos (L * A floats, linha a linha) e de N agentes
+// (int x, int y, float energia), na ordem dos ranks. Retorna false no rank 0 se o arquivo não abrir.
+bool gravar_snapshot(MPI_Comm comm, int rank, int ciclo, const Territorio& subgrid, const VetorAgentes& agentes,
+                     int largura_grid, int altura_grid, const std::string& arquivo);
+
+#endif // SERVICO_HPP
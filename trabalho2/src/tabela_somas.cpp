@@ -0,0 +1,94 @@
+#include "tabela_somas.hpp"
+#include <algorithm>
+
+namespace {
+    // Colunas por bloco no prefixo vertical: cada thread soma uma faixa estreita de colunas linha
+    // a linha, com a linha anterior ainda no cache
+    constexpr int COLUNAS_POR_BLOCO = 128;
+}
+
+void TabelaSomas::construir(const Territorio& grid, const Agente* agentes, int num_agentes) {
+    largura = grid.get_largura();
+    altura = grid.get_altura();
+    passo = largura + 1;
+    offset = grid.get_offset();
+    soma_recurso.resize((size_t)passo * (altura + 1));
+    soma_agentes.resize((size_t)passo * (altura + 1));
+    contagem.resize((size_t)largura * altura);
+    int num_blocos = (largura + COLUNAS_POR_BLOCO - 1) / COLUNAS_POR_BLOCO;
+
+    #pragma omp parallel
+    {
+        #pragma omp for schedule(static)
+        for (int y = 0; y < altura; ++y) {
+            std::fill(&contagem[(size_t)y * largura], &contagem[(size_t)y * largura] + largura, 0);
+        }
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < num_agentes; ++i) {
+            Posicao p = agentes[i].get_posicao();
+            #pragma omp atomic
+            contagem[(size_t)(p.y - offset.y) * largura + (p.x - offset.x)]++;
+        }
+
+        // Linha 0 (cantos zerados) e prefixo de cada linha
+        #pragma omp single nowait
+        {
+            std::fill(soma_recurso.begin(), soma_recurso.begin() + passo, 0.0);
+            std::fill(soma_agentes.begin(), soma_agentes.begin() + passo, 0);
+        }
+        #pragma omp for schedule(static)
+        for (int y = 0; y < altura; ++y) {
+            const float* recurso = grid.ptr_recurso(Posicao(0, y));
+            const int* cont = &contagem[(size_t)y * largura];
+            double* sr = &soma_recurso[(size_t)(y + 1) * passo];
+            int* sa = &soma_agentes[(size_t)(y + 1) * passo];
+            double acumulado_recurso = 0.0;
+            int acumulado_agentes = 0;
+            sr[0] = 0.0;
+            sa[0] = 0;
+            for (int x = 0; x < largura; ++x) {
+                acumulado_recurso += recurso[x];
+                acumulado_agentes += cont[x];
+                sr[x + 1] = acumulado_recurso;
+                sa[x + 1] = acumulado_agentes;
+            }
+        }
+
+        // Prefixo das colunas: a linha y + 1 soma a linha y já acumulada
+        #pragma omp for schedule(static)
+        for (int b = 0; b < num_blocos; ++b) {
+            int x0 = 1 + b * COLUNAS_POR_BLOCO;
+            int x1 = std::min(passo, x0 + COLUNAS_POR_BLOCO);
+            for (int y = 2; y <= altura; ++y) {
+                double* sr = &soma_recurso[(size_t)y * passo];
+                const double* sr_acima = sr - passo;
+                int* sa = &soma_agentes[(size_t)y * passo];
+                const int* sa_acima = sa - passo;
+                #pragma omp simd
+                for (int x = x0; x < x1; ++x) {
+                    sr[x] += sr_acima[x];
+                    sa[x] += sa_acima[x];
+                }
+            }
+        }
+    }
+}
+
+bool TabelaSomas::recortar(int& gx0, int& gy0, int& gx1, int& gy1) const {
+    gx0 = std::max(gx0 - offset.x, 0);
+    gx1 = std::min(gx1 - offset.x, largura);
+    gy0 = std::max(gy0 - offset.y, 0);
+    gy1 = std::min(gy1 - offset.y, altura);
+    return gx0 < gx1 && gy0 < gy1;
+}
+
+double TabelaSomas::recursos(int gx0, int gy0, int gx1, int gy1) const {
+    if (!recortar(gx0, gy0, gx1, gy1)) return 0.0;
+    return somar(soma_recurso, gx0, gy0, gx1, gy1);
+}
+
+int TabelaSomas::agentes(int gx0, int gy0, int gx1, int gy1) const {
+    if (!recortar(gx0, gy0, gx1, gy1)) return 0;
+    return somar(soma_agentes, gx0, gy0, gx1, gy1);
+}
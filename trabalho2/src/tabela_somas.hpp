@@ -0,0 +1,49 @@
+#ifndef TABELA_SOMAS_HPP
+#define TABELA_SOMAS_HPP
+
+#include <vector>
+#include "agente.hpp"
+#include "territorio.hpp"
+
+// Tabela de somas acumuladas (imagem integral) do subgrid: para cada canto (x, y), a soma do
+// recurso e o número de agentes nas células locais [0, x) x [0, y). Com ela, o total de qualquer
+// retângulo sai de quatro leituras, sem varrer a grade: S(x1,y1) - S(x0,y1) - S(x1,y0) + S(x0,y0).
+//
+// É opcional e construída sob demanda, no máximo uma vez por ciclo (quem consulta reconstrói
+// depois que o ciclo muda o território). Numa consulta distribuída, cada rank responde pela
+// interseção do retângulo com a sua faixa e as respostas são somadas entre os processos.
+class TabelaSomas {
+private:
+    int largura;
+    int altura;
+    int passo;                        // largura + 1 (a linha 0 e a coluna 0 são os cantos zerados)
+    Posicao offset;                   // Posição global de início do subgrid
+    std::vector<double> soma_recurso; // (altura + 1) x passo
+    std::vector<int> soma_agentes;    // (altura + 1) x passo
+    std::vector<int> contagem;        // Agentes por célula (auxiliar da construção)
+
+    // Recorta o retângulo GLOBAL [gx0, gx1) x [gy0, gy1) ao subgrid, em coordenadas locais.
+    // false se a interseção for vazia
+    bool recortar(int& gx0, int& gy0, int& gx1, int& gy1) const;
+
+    template <typename T>
+    T somar(const std::vector<T>& tabela, int x0, int y0, int x1, int y1) const {
+        return tabela[(size_t)y1 * passo + x1] - tabela[(size_t)y0 * passo + x1] -
+               tabela[(size_t)y1 * passo + x0] + tabela[(size_t)y0 * passo + x0];
+    }
+
+public:
+    TabelaSomas() : largura(0), altura(0), passo(1) {}
+
+    // Reconstrói a tabela a partir do plano de recurso corrente de `grid` e dos `num_agentes`
+    // agentes (todos dentro do subgrid), em paralelo: contagem dos agentes por célula, prefixo
+    // de cada linha (linhas independentes) e prefixo das colunas (blocos de colunas por thread,
+    // varrendo as linhas em ordem)
+    void construir(const Territorio& grid, const Agente* agentes, int num_agentes);
+
+    // Totais do retângulo GLOBAL [gx0, gx1) x [gy0, gy1) nas células deste subgrid (0 fora dele), O(1)
+    double recursos(int gx0, int gy0, int gx1, int gy1) const;
+    int agentes(int gx0, int gy0, int gx1, int gy1) const;
+};
+
+#endif // TABELA_SOMAS_HPP
@@ -1,115 +1,176 @@
 #include "territorio.hpp"
 #include "config.hpp"
+#include "regras.hpp"
 #include <omp.h>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
-Territorio::Territorio(int w, int h, Posicao offset_inicial)
-    : largura(w), altura(h), offset(offset_inicial) {
+Territorio::Territorio(int w, int h, Posicao offset_inicial, float* memoria_externa)
+    : largura(w), altura(h), passo(w + 2), offset(offset_inicial), estacao(Estacao::SECA),
+      base(memoria_externa), plano((w + 2) * (h + 2)), atual(0),
+      halo_sup_externo(nullptr), halo_inf_externo(nullptr), piramide(nullptr) {
     
     // Aloca continuamente na memória - melhor para cache misses (L1, L2)
-    // E permite buffer contíguo ao passar para o MPI
-    grid.resize(largura * altura);
-}
-
-// Funções determinísticas espaciais
-TipoCelula Territorio::f_tipo(Posicao global) const {
-    // Exemplo de mapeamento determinístico. Intercale ou utilize uma função hash sobre gx/gy.
-    if ((global.x % Config::MODULO_ALDEIA == 0) && (global.y % Config::MODULO_ALDEIA == 0)) return TipoCelula::ALDEIA;
-    if (global.x % Config::MODULO_PESCA == 0) return TipoCelula::PESCA; // rios passam nesses eixos
-    if (global.y % Config::MODULO_ROCADO == 0) return TipoCelula::ROCADO;
-    return TipoCelula::COLETA;
-}
-
-float Territorio::f_recurso(TipoCelula tipo) const {
-    switch (tipo) {
-        case TipoCelula::ALDEIA: return Config::RECURSO_MAX_ALDEIA;
-        case TipoCelula::PESCA: return Config::RECURSO_MAX_PESCA;
-        case TipoCelula::ROCADO: return Config::RECURSO_MAX_ROCADO;
-        case TipoCelula::COLETA: return Config::RECURSO_MAX_COLETA;
-        case TipoCelula::INTERDITA: return 0.0f;
-        default: return 0.0f;
+    // E permite buffer contíguo ao passar para o MPI (cada linha, halos inclusive, é contígua)
+    if (base == nullptr) {
+        memoria_propria.resize(floats_com_borda(largura, altura));
+        base = memoria_propria.data();
     }
+    recurso[0] = base + deslocamento_linha(largura, 0);
+    recurso[1] = recurso[0] + plano;
+    consumo = recurso[1] + plano;
 }
 
-bool Territorio::f_acesso(TipoCelula tipo, Estacao estacao) const {
-    // Exemplo: na estação cheia áreas de pesca podem expandir, ou áreas interditadas mudarem
-    if (tipo == TipoCelula::INTERDITA) return false;
-    if (estacao == Estacao::CHEIA && tipo == TipoCelula::COLETA) return false; // Inundou a coleta
-    return true;
+Territorio::Territorio(Territorio& pai, int y_ini, int h)
+    : largura(pai.largura), altura(h), passo(pai.passo), offset(pai.offset.x, pai.offset.y + y_ini),
+      estacao(pai.estacao), base(nullptr), plano(pai.plano), atual(pai.atual),
+      halo_sup_externo(nullptr), halo_inf_externo(nullptr), piramide(pai.piramide) {
+    recurso[0] = pai.recurso[0] + y_ini * passo;
+    recurso[1] = pai.recurso[1] + y_ini * passo;
+    consumo = pai.consumo + y_ini * passo;
 }
 
 float Territorio::f_regeneracao(Estacao estacao) const {
-    // Retorna a taxa de regeneração baseada na estação
-    return estacao == Estacao::CHEIA ? Config::TAXA_REGENERACAO_CHEIA : Config::TAXA_REGENERACAO_SECA;
+    // Retorna a taxa de regeneração baseada na estação (regras do cenário)
+    return estacao == Estacao::CHEIA ? Regras::atuais.taxa_regeneracao_cheia : Regras::atuais.taxa_regeneracao_seca;
 }
 
 void Territorio::inicializar(Estacao estacao_inicial) {
+    estacao = estacao_inicial;
+
     // Utilização de OpenMP para inicialização distribuída no multicore (first-touch policy p/ NUMA)
-    // collapse(2) para "juntar" os dois loops
-    // schedule(static) para eficiência na distribuição de trabalho
-    #pragma omp parallel for collapse(2) schedule(static)
-    for (int y = 0; y < altura; ++y) {
-        for (int x = 0; x < largura; ++x) {
-            Posicao global(offset.x + x, offset.y + y);
-            
-            TipoCelula tipo = f_tipo(global);
-            float recurso = f_recurso(tipo);
-            bool acessivel = f_acesso(tipo, estacao_inicial);
-
-            int index = y * largura + x;
-            grid[index].tipo = tipo;
-            grid[index].recurso = recurso;
-            grid[index].consumo_acumulado_na_celula = 0.0f;
-            grid[index].acessivel = acessivel;
+    // Cada thread inicializa a sua faixa de linhas (linha_inicial_faixa), a mesma faixa cujos
+    // agentes ela vai processar: as páginas da grade ficam no nó NUMA de quem as usa.
+    // Tipo e acessibilidade não são materializados: só o estado dinâmico é escrito.
+    // O anel fantasma recebe sentinelas, tocado pela thread dona da faixa adjacente: as colunas
+    // de borda junto com as próprias linhas, as linhas de halo pela primeira e pela última thread.
+    // As linhas de halo com vizinho são sobrescritas na troca de halos de cada ciclo.
+    // Os dois planos de recurso recebem as sentinelas do anel (a atualização só escreve células
+    // próprias, então as colunas fantasmas do próximo plano nunca mudam) e o consumo começa zerado.
+    #pragma omp parallel
+    {
+        int num_faixas = omp_get_num_threads();
+        int t = omp_get_thread_num();
+        int y_ini = linha_inicial_faixa(t, num_faixas);
+        int y_fim = linha_inicial_faixa(t + 1, num_faixas);
+        if (t == 0) y_ini = -1;
+        if (t == num_faixas - 1) y_fim = altura + 1;
+
+        for (int y = y_ini; y < y_fim; ++y) {
+            float* linha_a = recurso[0] + y * passo;
+            float* linha_b = recurso[1] + y * passo;
+            float* linha_consumo = consumo + y * passo;
+            for (int x = -1; x <= largura; ++x) {
+                bool fantasma = y < 0 || y >= altura || x < 0 || x >= largura;
+                float valor = fantasma ? RECURSO_FANTASMA : TabelasTerritorio::capacidade(offset.x + x, offset.y + y);
+                linha_a[x] = valor;
+                linha_b[x] = valor;
+                linha_consumo[x] = 0.0f;
+            }
         }
     }
 }
 
-void Territorio::atualizar_acessibilidade(Estacao nova_estacao) {
-    // Apenas recalcula o status de acesso nas células, de acordo com a nova estação
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < (int)grid.size(); ++i) {
-        grid[i].acessivel = f_acesso(grid[i].tipo, nova_estacao);
+void Territorio::copiar_halos_externos() {
+    // Plano corrente do vizinho: mesmo índice que o nosso (todos trocam de plano no mesmo ciclo)
+    int desloc = atual * plano;
+    if (halo_sup_externo) std::copy(halo_sup_externo + desloc, halo_sup_externo + desloc + largura, ptr_halo_sup());
+    if (halo_inf_externo) std::copy(halo_inf_externo + desloc, halo_inf_externo + desloc + largura, ptr_halo_inf());
+}
+
+template <bool BALANCO>
+void Territorio::atualizar_linhas(int y_ini, int y_fim, float regeneracao_base, float& soma_consumo, float& soma_recursos) {
+    // Operações em array contíguo: ótimo uso de prefetching!
+    // A capacidade máxima vem da linha correspondente da tabela periódica (cabe na L1)
+    for (int y = y_ini; y < y_fim; ++y) {
+        const auto& tipos_linha = TabelasTerritorio::TIPOS[(offset.y + y) % TabelasTerritorio::PERIODO_Y];
+        const float* linha_atual = recurso[atual] + y * passo;
+        float* linha_prox = recurso[1 - atual] + y * passo;
+        float* linha_consumo = consumo + y * passo;
+
+        for (int x = 0; x < largura; ++x) {
+            // Recurso += regeneracao - consumo_acumulado (limitado ao máx possível de recursos)
+            TipoCelula tipo = tipos_linha[(offset.x + x) % TabelasTerritorio::PERIODO_X];
+            float maximo_capacidade = TabelasTerritorio::CAPACIDADE_POR_TIPO[static_cast<int>(tipo)];
+            float consumido = linha_consumo[x];
+            float novo_recurso = linha_atual[x] + regeneracao_base - consumido;
+            
+            // Clamping manual
+            if (novo_recurso > maximo_capacidade) novo_recurso = maximo_capacidade;
+            if (novo_recurso < 0.0f) novo_recurso = 0.0f;
+            
+            linha_prox[x] = novo_recurso;
+            
+            // Zera o consumo para o próximo ciclo
+            linha_consumo[x] = 0.0f;
+
+            if (BALANCO) {
+                soma_consumo += consumido;
+                soma_recursos += novo_recurso;
+            }
+        }
     }
 }
 
 void Territorio::atualizar_recursos(Estacao estacao_atual) {
     float regeneracao_base = f_regeneracao(estacao_atual);
     
-    // Operações em array contíguo: ótimo uso de prefetching!
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < (int)grid.size(); ++i) {
-        // Recurso += regeneracao - consumo_acumulado (limitado ao máx possível de recursos)
-        float maximo_capacidade = f_recurso(grid[i].tipo);
-        float novo_recurso = grid[i].recurso + regeneracao_base - grid[i].consumo_acumulado_na_celula;
-        
-        // Clamping manual
-        if (novo_recurso > maximo_capacidade) novo_recurso = maximo_capacidade;
-        if (novo_recurso < 0.0f) novo_recurso = 0.0f;
-        
-        grid[i].recurso = novo_recurso;
-        
-        // Zera o consumo para o próximo ciclo
-        grid[i].consumo_acumulado_na_celula = 0.0f;
+    // Mesmas faixas de linhas do first-touch: cada thread atualiza as páginas que são locais a ela
+    #pragma omp parallel
+    {
+        int num_faixas = omp_get_num_threads();
+        int t = omp_get_thread_num();
+        float ignorado = 0.0f;
+        atualizar_linhas<false>(linha_inicial_faixa(t, num_faixas), linha_inicial_faixa(t + 1, num_faixas),
+                                regeneracao_base, ignorado, ignorado);
+    }
+    atual = 1 - atual;
+}
+
+BalancoRecursos Territorio::atualizar_recursos_com_balanco(Estacao estacao_atual, int balanco_ini, int balanco_fim) {
+    float regeneracao_base = f_regeneracao(estacao_atual);
+    float total_consumo = 0.0f;
+    float total_recursos = 0.0f;
+
+    #pragma omp parallel reduction(+:total_consumo, total_recursos)
+    {
+        int num_faixas = omp_get_num_threads();
+        int t = omp_get_thread_num();
+        int y_ini = linha_inicial_faixa(t, num_faixas);
+        int y_fim = linha_inicial_faixa(t + 1, num_faixas);
+
+        // Trechos da faixa antes, dentro e depois das linhas contabilizadas
+        int conta_ini = std::min(std::max(y_ini, balanco_ini), y_fim);
+        int conta_fim = std::max(std::min(y_fim, balanco_fim), conta_ini);
+        float ignorado = 0.0f;
+        atualizar_linhas<false>(y_ini, conta_ini, regeneracao_base, ignorado, ignorado);
+        atualizar_linhas<true>(conta_ini, conta_fim, regeneracao_base, total_consumo, total_recursos);
+        atualizar_linhas<false>(conta_fim, y_fim, regeneracao_base, ignorado, ignorado);
     }
+    atual = 1 - atual;
+    return BalancoRecursos{total_consumo, total_recursos};
 }
 
 void Territorio::registrar_consumo(Posicao local, float quantidade) {
-    int index = local.y * largura + local.x;
+    int index = local.y * passo + local.x;
     
     // Como os agentes são processados em paralelo (via threads OpenMP),
     // vários agentes podem tentar consumir na MESMA célula simultaneamente!
     // A soma deve ser atômica.
+    // O plano de consumo é separado do de recurso: o atômico não invalida as linhas de cache que
+    // os estênceis das outras threads estão lendo.
     #pragma omp atomic
-    grid[index].consumo_acumulado_na_celula += quantidade;
+    consumo[index] += quantidade;
 }
 
+// As reduções percorrem só as células próprias, linha a linha (o anel fantasma fica de fora)
 float Territorio::get_recursos_totais() const {
     float total = 0.0f;
     #pragma omp parallel for reduction(+:total)
-    for (int i = 0; i < (int)grid.size(); ++i) {
-        total += grid[i].recurso;
+    for (int y = 0; y < altura; ++y) {
+        const float* linha = recurso[atual] + y * passo;
+        for (int x = 0; x < largura; ++x) total += linha[x];
     }
     return total;
 }
@@ -117,13 +178,14 @@ float Territorio::get_recursos_totais() const {
 float Territorio::get_consumo_total() const {
     float total = 0.0f;
     #pragma omp parallel for reduction(+:total)
-    for (int i = 0; i < (int)grid.size(); ++i) {
-        total += grid[i].consumo_acumulado_na_celula;
+    for (int y = 0; y < altura; ++y) {
+        const float* linha = consumo + y * passo;
+        for (int x = 0; x < largura; ++x) total += linha[x];
     }
     return total;
 }
 
 float Territorio::get_regeneracao_total(Estacao estacao) const {
     // A regeneração é o potencial total da natureza no subgrid
-    return f_regeneracao(estacao) * grid.size();
+    return f_regeneracao(estacao) * get_tamanho_total();
 }
@@ -2,7 +2,10 @@
 #define TERRITORIO_HPP
 
 #include <vector>
+#include <array>
+#include <numeric>
 #include "posicao.hpp"
+#include "config.hpp"
 
 // Representa os tipos de células possíveis no território
 enum class TipoCelula {
@@ -19,84 +22,280 @@ enum class Estacao {
     CHEIA
 };
 
-// Estrutura principal da célula
-// Utilizando atributos básicos para garantir localidade de cache e permitir que seja fácil
-// realizar a comunicação via MPI futuramente.
-struct Celula {
-    TipoCelula tipo;
-    float recurso;
-    float consumo_acumulado_na_celula; // Útil para abater do recurso final na fase da atualização
-    bool acessivel;
+// O estado de uma célula é só dinâmico (recurso e consumo acumulado no ciclo): tipo, capacidade
+// máxima e acessibilidade são funções puras da posição global (e da estação) e são calculados sob
+// demanda pelas tabelas abaixo. Esse estado fica em planos separados de floats no Territorio.
+
+// Tabelas constexpr dos atributos estáticos do território.
+// O padrão de tipos (f_tipo) é periódico: em X repete a cada mmc(MODULO_ALDEIA, MODULO_PESCA)
+// e em Y a cada mmc(MODULO_ALDEIA, MODULO_ROCADO). Basta tabelar um único período.
+namespace TabelasTerritorio {
+    constexpr int PERIODO_X = std::lcm(Config::MODULO_ALDEIA, Config::MODULO_PESCA);
+    constexpr int PERIODO_Y = std::lcm(Config::MODULO_ALDEIA, Config::MODULO_ROCADO);
+    constexpr int NUM_TIPOS = 5;
+    constexpr int NUM_ESTACOES = 2;
+
+    // Mapeamento determinístico do tipo a partir da posição global (f_tipo)
+    constexpr TipoCelula f_tipo(int gx, int gy) {
+        if ((gx % Config::MODULO_ALDEIA == 0) && (gy % Config::MODULO_ALDEIA == 0)) return TipoCelula::ALDEIA;
+        if (gx % Config::MODULO_PESCA == 0) return TipoCelula::PESCA; // rios passam nesses eixos
+        if (gy % Config::MODULO_ROCADO == 0) return TipoCelula::ROCADO;
+        return TipoCelula::COLETA;
+    }
+
+    // Recurso máximo por tipo (f_recurso), indexado por TipoCelula
+    constexpr std::array<float, NUM_TIPOS> CAPACIDADE_POR_TIPO = {
+        Config::RECURSO_MAX_ALDEIA,  // ALDEIA
+        Config::RECURSO_MAX_PESCA,   // PESCA
+        Config::RECURSO_MAX_COLETA,  // COLETA
+        Config::RECURSO_MAX_ROCADO,  // ROCADO
+        0.0f                         // INTERDITA
+    };
+
+    // Acessibilidade por estação e tipo (f_acesso), indexada por [Estacao][TipoCelula]
+    // Na cheia a coleta inunda; áreas interditadas nunca são acessíveis.
+    constexpr bool ACESSO[NUM_ESTACOES][NUM_TIPOS] = {
+        // ALDEIA PESCA  COLETA ROCADO INTERDITA
+        {  true,  true,  true,  true,  false }, // SECA
+        {  true,  true,  false, true,  false }  // CHEIA
+    };
+
+    using Periodo = std::array<std::array<TipoCelula, PERIODO_X>, PERIODO_Y>;
+
+    constexpr Periodo gerar_tipos() {
+        Periodo tabela{};
+        for (int y = 0; y < PERIODO_Y; ++y)
+            for (int x = 0; x < PERIODO_X; ++x)
+                tabela[y][x] = f_tipo(x, y);
+        return tabela;
+    }
+
+    constexpr Periodo TIPOS = gerar_tipos();
+
+    constexpr TipoCelula tipo(int gx, int gy) {
+        return TIPOS[gy % PERIODO_Y][gx % PERIODO_X];
+    }
+
+    constexpr float capacidade(int gx, int gy) {
+        return CAPACIDADE_POR_TIPO[static_cast<int>(tipo(gx, gy))];
+    }
+
+    constexpr bool acessivel(int gx, int gy, Estacao estacao) {
+        return ACESSO[static_cast<int>(estacao)][static_cast<int>(tipo(gx, gy))];
+    }
+
+    // Vizinhança de Moore na ordem de varredura (a ordem define o desempate: vence o primeiro máximo)
+    constexpr int VIZINHO_DX[8] = {-1,  0,  1, -1, 1, -1, 0, 1};
+    constexpr int VIZINHO_DY[8] = {-1, -1, -1,  0, 0,  1, 1, 1};
+
+    // Acessibilidade da vizinhança de Moore: tabela do período estendida de uma célula em cada
+    // borda, indexada por [estacao][py + 1 + dy][px + 1 + dx] com (px, py) = posição no período.
+    // Com ela o estêncil de 8 vizinhos faz só um módulo por eixo (o do agente), sem desvios.
+    using PeriodoEstendido = std::array<std::array<bool, PERIODO_X + 2>, PERIODO_Y + 2>;
+
+    constexpr std::array<PeriodoEstendido, NUM_ESTACOES> gerar_acesso_vizinhanca() {
+        std::array<PeriodoEstendido, NUM_ESTACOES> tabela{};
+        for (int e = 0; e < NUM_ESTACOES; ++e)
+            for (int y = 0; y < PERIODO_Y + 2; ++y)
+                for (int x = 0; x < PERIODO_X + 2; ++x)
+                    tabela[e][y][x] = ACESSO[e][static_cast<int>(
+                        TIPOS[(y - 1 + PERIODO_Y) % PERIODO_Y][(x - 1 + PERIODO_X) % PERIODO_X])];
+        return tabela;
+    }
+
+    constexpr std::array<PeriodoEstendido, NUM_ESTACOES> ACESSO_VIZINHANCA = gerar_acesso_vizinhanca();
+
+    // A mesma informação compactada: para cada posição do período, uma máscara de 8 bits com o
+    // bit i ligado se o vizinho i (VIZINHO_DX/DY) é acessível. Uma única leitura por agente
+    // basta para o estêncil inteiro (usada pelo kernel em lote).
+    using MascarasPeriodo = std::array<std::array<int, PERIODO_X>, PERIODO_Y>;
+
+    constexpr std::array<MascarasPeriodo, NUM_ESTACOES> gerar_mascaras_vizinhanca() {
+        std::array<MascarasPeriodo, NUM_ESTACOES> tabela{};
+        for (int e = 0; e < NUM_ESTACOES; ++e)
+            for (int y = 0; y < PERIODO_Y; ++y)
+                for (int x = 0; x < PERIODO_X; ++x)
+                    for (int i = 0; i < 8; ++i)
+                        tabela[e][y][x] |= (ACESSO_VIZINHANCA[e][y + 1 + VIZINHO_DY[i]][x + 1 + VIZINHO_DX[i]] ? 1 : 0) << i;
+        return tabela;
+    }
+
+    constexpr std::array<MascarasPeriodo, NUM_ESTACOES> MASCARA_VIZINHANCA = gerar_mascaras_vizinhanca();
+
+    static_assert(tipo(0, 0) == TipoCelula::ALDEIA, "tabela de tipos inconsistente");
+    static_assert(ACESSO_VIZINHANCA[0][1][1] == ACESSO[0][static_cast<int>(TipoCelula::ALDEIA)],
+                  "tabela de vizinhança inconsistente");
+    static_assert(tipo(PERIODO_X + 5, 3) == f_tipo(PERIODO_X + 5, 3), "tabela de tipos inconsistente");
+}
+
+class PiramideRecursos;
+
+// Totais da fase de recursos de um ciclo (métricas), obtidos na mesma região paralela da atualização
+struct BalancoRecursos {
+    float consumo;   // Consumo acumulado no ciclo, antes da atualização
+    float recursos;  // Recursos totais depois da atualização
 };
 
 class Territorio {
 private:
     int largura;
     int altura;
+    int passo;      // Células por linha da grade com borda (largura + 2)
     Posicao offset; // Posição global de início do subgrid
+    Estacao estacao; // Estação vigente: basta ela para derivar a acessibilidade de qualquer célula
     
     // Matriz 1D contínua é muito mais eficiente computacionalmente para OpenMP (cache friendly) e MPI (facilita envio de blocos/halos)
-    std::vector<Celula> grid;
-    std::vector<Celula> halo_sup;
-    std::vector<Celula> halo_inf;
-
-    // Funções auxiliares (de acordo com as regras de negócio abstratas)
-    TipoCelula f_tipo(Posicao global) const;
-    float f_recurso(TipoCelula tipo) const;
-    bool f_acesso(TipoCelula tipo, Estacao estacao) const;
+    // A grade tem um anel fantasma de uma célula: as linhas -1 e `altura` guardam os halos no
+    // lugar e as colunas -1 e `largura` guardam sentinelas (RECURSO_FANTASMA). Assim qualquer
+    // vizinho de Moore de uma célula própria é um endereço válido e o estêncil não tem desvios.
+    //
+    // Estado em três planos de floats com esse mesmo formato, em sequência na memória:
+    //   [recurso A][recurso B][consumo]
+    // Os recursos têm buffer duplo: durante o laço de agentes o plano corrente é só lido, e
+    // atualizar_recursos escreve o próximo plano a partir dele e do consumo, trocando os dois no
+    // fim. O consumo (escrito atomicamente pelos agentes) fica num plano à parte, longe das
+    // linhas de cache de recurso lidas pelos estênceis das outras threads: sem false sharing.
+    // `base` aponta para `memoria_propria` ou para memória externa (ex.: janela MPI compartilhada
+    // do nó); `recurso[p]` e `consumo` apontam para a célula local (0, 0) de cada plano.
+    std::vector<float> memoria_propria;
+    float* base;
+    int plano;          // Distância (em floats) entre planos consecutivos
+    float* recurso[2];
+    float* consumo;
+    int atual;          // Plano de recurso corrente (0 ou 1)
+
+    // Linhas de borda de vizinhos no mesmo nó (memória compartilhada), no plano de recurso A do
+    // vizinho; copiadas do plano corrente para as linhas fantasmas a cada ciclo.
+    // nullptr = halo por mensagem MPI ou inexistente.
+    const float* halo_sup_externo;
+    const float* halo_inf_externo;
+
+    // Pirâmide de recursos da percepção estendida (PERCEPCAO_ESTENDIDA), mantida por quem roda os
+    // ciclos; nullptr = só a vizinhança de Moore
+    const PiramideRecursos* piramide;
+
+    // Função auxiliar (de acordo com as regras de negócio abstratas)
     float f_regeneracao(Estacao estacao) const;
 
+    // Escreve no próximo plano as linhas locais [y_ini, y_fim) atualizadas e zera o consumo delas.
+    // Com BALANCO, soma também o consumo lido e o recurso resultante de cada célula
+    template <bool BALANCO>
+    void atualizar_linhas(int y_ini, int y_fim, float regeneracao_base, float& soma_consumo, float& soma_recursos);
+
 public:
-    // Construtor: Inicializa a grade baseada na divisão espacial
-    Territorio(int w, int h, Posicao offset_inicial);
+    // Recurso das células fantasmas sem dono (bordas do grid global): nunca vence a comparação
+    // com uma célula real (recurso >= 0) nos estênceis de decisão e reprodução
+    static constexpr float RECURSO_FANTASMA = -1.0f;
+
+    // Número de floats dos três planos da grade com o anel fantasma (tamanho da memória externa, se usada)
+    static int floats_com_borda(int w, int h) { return 3 * (w + 2) * (h + 2); }
+
+    // Posição da célula local (0, y) dentro de um plano de largura `w` (ex.: para localizar a
+    // linha de borda de um vizinho na memória compartilhada)
+    static int deslocamento_linha(int w, int y) { return (y + 1) * (w + 2) + 1; }
+
+    // Construtor: Inicializa a grade baseada na divisão espacial.
+    // Se `memoria_externa` for fornecida (floats_com_borda(w, h) floats), a grade vive nela e não é alocada aqui.
+    Territorio(int w, int h, Posicao offset_inicial, float* memoria_externa = nullptr);
+
+    // Vista das linhas locais [y_ini, y_ini + h) de `pai`, sobre a mesma memória (os três planos):
+    // as linhas vizinhas do pai servem de anel fantasma. O plano corrente acompanha o pai por
+    // seguir_plano (depois de cada atualização feita pelo pai).
+    Territorio(Territorio& pai, int y_ini, int h);
+
+    Territorio(const Territorio&) = delete;
+    Territorio& operator=(const Territorio&) = delete;
 
-    // Inicializa os atributos da célula baseado na posição global
+    // Inicializa os atributos da célula baseado na posição global (e as sentinelas do anel)
     void inicializar(Estacao estacao_inicial);
 
-    // Métricas principais para OpenMP parallel for
-    void atualizar_acessibilidade(Estacao nova_estacao);
+    // A acessibilidade é derivada da estação sob demanda: trocar de estação é O(1)
+    void atualizar_acessibilidade(Estacao nova_estacao) { estacao = nova_estacao; }
+
+    // Métricas principais para OpenMP parallel for (escreve o próximo plano e troca os planos)
     void atualizar_recursos(Estacao estacao_atual);
 
+    // Fase de recursos do ciclo numa só varredura da grade (uma região paralela, sem barreiras):
+    // cada thread, nas suas faixas de linhas, lê o consumo de cada célula, atualiza-a e soma o
+    // recurso resultante. Só as linhas locais [balanco_ini, balanco_fim) entram nos totais (o bloco
+    // temporal conta apenas a faixa própria do território estendido).
+    BalancoRecursos atualizar_recursos_com_balanco(Estacao estacao_atual, int balanco_ini, int balanco_fim);
+    BalancoRecursos atualizar_recursos_com_balanco(Estacao estacao_atual) {
+        return atualizar_recursos_com_balanco(estacao_atual, 0, altura);
+    }
+
     // Consumo de recurso por um agente localmente (precisa ser atômico dependendo do de como os agentes operam)
     void registrar_consumo(Posicao local, float quantidade);
 
-    // Acessos à célula usando mapeamento de 2D para 1D
-    inline Celula& get_celula(Posicao local) {
-        return grid[local.y * largura + local.x];
+    // Acessos ao plano de recurso corrente usando mapeamento de 2D para 1D (coordenadas de -1 a
+    // largura/altura caem no anel fantasma)
+    inline float get_recurso(Posicao local) const {
+        return recurso[atual][local.y * passo + local.x];
     }
-    
-    inline const Celula& get_celula(Posicao local) const {
-        return grid[local.y * largura + local.x];
+    inline const float* ptr_recurso(Posicao local) const {
+        return recurso[atual] + local.y * passo + local.x;
+    }
+    inline float* ptr_recurso(Posicao local) {
+        return recurso[atual] + local.y * passo + local.x;
     }
 
-    void alocar_halos(bool tem_sup, bool tem_inf) {
-        if (tem_sup) halo_sup.resize(largura);
-        if (tem_inf) halo_inf.resize(largura);
+    // Consumo acumulado no ciclo corrente
+    inline float get_consumo(Posicao local) const {
+        return consumo[local.y * passo + local.x];
     }
 
-    bool tem_halo_sup() const { return !halo_sup.empty(); }
-    bool tem_halo_inf() const { return !halo_inf.empty(); }
+    // Plano de recurso corrente (0 ou 1). Vistas sobre a mesma memória acompanham o dono com
+    // seguir_plano depois de cada atualização dele.
+    int get_plano_atual() const { return atual; }
+    void seguir_plano(const Territorio& dono) { atual = dono.atual; }
+
+    // Aponta um halo para a linha de borda do vizinho (memória compartilhada do nó), no plano A
+    // dele. O vizinho tem as mesmas dimensões e troca de plano no mesmo ciclo, então o plano
+    // corrente dele fica à mesma distância; copiar_halos_externos copia essa linha para a linha
+    // fantasma, sem mensagem MPI.
+    void usar_halo_sup_externo(const float* linha) { halo_sup_externo = linha; }
+    void usar_halo_inf_externo(const float* linha) { halo_inf_externo = linha; }
+    void copiar_halos_externos();
 
-    const Celula& get_halo_sup(int x) const { return halo_sup[x]; }
-    const Celula& get_halo_inf(int x) const { return halo_inf[x]; }
+    // Pirâmide consultada pelas decisões dos agentes (vistas herdam a do pai)
+    void usar_piramide(const PiramideRecursos* p) { piramide = p; }
+    const PiramideRecursos* get_piramide() const { return piramide; }
 
-    Celula* ptr_linha_sup() { return grid.data(); }
-    Celula* ptr_linha_inf() { return grid.data() + (altura - 1) * largura; }
-    Celula* ptr_halo_sup() { return halo_sup.data(); }
-    Celula* ptr_halo_inf() { return halo_inf.data(); }
+    // Linhas de borda e fantasmas do plano de recurso corrente (só o recurso trafega nos halos)
+    float* ptr_linha_sup() { return recurso[atual]; }
+    float* ptr_linha_inf() { return recurso[atual] + (altura - 1) * passo; }
+    float* ptr_halo_sup() { return recurso[atual] - passo; }
+    float* ptr_halo_inf() { return recurso[atual] + altura * passo; }
+
+    // Deslocamento entre linhas consecutivas (para estênceis sobre ptr_recurso)
+    int get_passo() const { return passo; }
+
+    // Atributos estáticos calculados sob demanda a partir da posição GLOBAL
+    // (valem também para as células dos halos, que pertencem a outro processo)
+    TipoCelula get_tipo(Posicao global) const { return TabelasTerritorio::tipo(global.x, global.y); }
+    float get_capacidade(Posicao global) const { return TabelasTerritorio::capacidade(global.x, global.y); }
+    bool is_acessivel(Posicao global) const { return TabelasTerritorio::acessivel(global.x, global.y, estacao); }
+
+    // Faixas de linhas por thread: a thread t de `num_faixas` é dona das linhas locais
+    // [linha_inicial_faixa(t), linha_inicial_faixa(t + 1)). É a mesma partição usada no
+    // first-touch da grade e na distribuição dos agentes entre threads (afinidade NUMA).
+    int linha_inicial_faixa(int t, int num_faixas) const {
+        return (int)((long long)t * altura / num_faixas);
+    }
+    int faixa_da_linha(int y_local, int num_faixas) const {
+        return (int)(((long long)(y_local + 1) * num_faixas - 1) / altura);
+    }
 
     // Getters úteis
     int get_largura() const { return largura; }
     int get_altura() const { return altura; }
     Posicao get_offset() const { return offset; }
+    Estacao get_estacao() const { return estacao; }
     int get_tamanho_total() const { return largura * altura; }
+    int get_tamanho_com_borda() const { return passo * (altura + 2); }
     float get_recursos_totais() const;
     float get_consumo_total() const;
     float get_regeneracao_total(Estacao estacao) const;
-    
-    // Retorna ponteiro bruto se precisar para operações de MPI
-    Celula* data() { return grid.data(); }
-    const Celula* data() const { return grid.data(); }
 };
 
 #endif // TERRITORIO_HPP